@@ -0,0 +1,502 @@
+/*
+ * ght_bench.c - Generic Hash Table benchmarks
+ *
+ * Copyright (c) 2024 Laurent Mailloux-Bourassa
+ *
+ * This file is part of the Generic Hash Table (GHT) library.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include <sys/resource.h>
+#include <unistd.h>
+#include "ght.h"
+
+#define BENCH_MIN_OPS       (1 << 20)   // Short runs on small tables are repeated up to this many operations.
+#define BENCH_MAX_OPS       (1 << 24)   // Caps the pregenerated lookup streams.
+#define BENCH_ZIPF_THETA    0.99
+#define BENCH_AUTO_RESIZE   0.75
+
+typedef enum bench_keys
+{
+    BENCH_KEYS_UNIFORM = 0,     // Scrambled 64-bit keys, looked up uniformly.
+    BENCH_KEYS_SEQUENTIAL,      // Keys 0 to n-1, looked up uniformly.
+    BENCH_KEYS_ZIPFIAN,         // Scrambled 64-bit keys, looked up with a Zipfian skew.
+} bench_keys_t;
+
+typedef struct bench_zipf
+{
+    uint64_t n;
+    double zetan;
+    double alpha;
+    double eta;
+    double threshold;
+} bench_zipf_t;
+
+typedef struct bench_cfg
+{
+    ght_cfg_t table;
+    size_t min_size;
+    size_t max_size;
+    size_t max_ops;
+    uint64_t seed;
+} bench_cfg_t;
+
+typedef struct bench_result
+{
+    const char* workload;
+    size_t size;
+    bench_keys_t keys;
+    bool auto_resize;
+    double hit_ratio;
+    double read_ratio;
+    size_t ops;
+    double seconds;
+    double bytes_per_entry;
+} bench_result_t;
+
+static const char* bench_keys_names[] = {"uniform", "sequential", "zipfian"};
+static const char* bench_engine_names[] = {"chained", "open_addressing", "robin_hood", "cuckoo"};
+static const char* bench_index_names[] = {"modulo", "pow2", "fastrange", "reciprocal"};
+
+static uint64_t bench_rng_state;
+static bool bench_first_result = true;
+
+static inline uint64_t bench_scramble(uint64_t x)
+{
+    // splitmix64 finalizer, a bijection so distinct indices give distinct keys.
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static inline uint64_t bench_rand(void)
+{
+    bench_rng_state += 0x9e3779b97f4a7c15ULL;
+    return bench_scramble(bench_rng_state);
+}
+
+static inline double bench_rand_double(void)
+{
+    return (bench_rand() >> 11) * 0x1.0p-53;
+}
+
+static inline ght_key_t bench_key(bench_keys_t keys, uint64_t index)
+{
+    return keys == BENCH_KEYS_SEQUENTIAL ? index : bench_scramble(index);
+}
+
+static void bench_zipf_init(bench_zipf_t* zipf, uint64_t n)
+{
+    // Gray et al., "Quickly Generating Billion-Record Synthetic Databases".
+    double zeta2 = 1.0 + pow(0.5, BENCH_ZIPF_THETA);
+
+    zipf->n = n;
+    zipf->zetan = 0.0;
+
+    for (uint64_t i = 1; i <= n; i++)
+    {
+        zipf->zetan += 1.0 / pow((double) i, BENCH_ZIPF_THETA);
+    }
+
+    zipf->alpha = 1.0 / (1.0 - BENCH_ZIPF_THETA);
+    zipf->eta = (1.0 - pow(2.0 / n, 1.0 - BENCH_ZIPF_THETA)) / (1.0 - zeta2 / zipf->zetan);
+    zipf->threshold = 1.0 + pow(0.5, BENCH_ZIPF_THETA);
+}
+
+static uint64_t bench_zipf_next(bench_zipf_t* zipf)
+{
+    double u = bench_rand_double();
+    double uz = u * zipf->zetan;
+
+    if (uz < 1.0) return 0;
+    if (uz < zipf->threshold) return 1;
+
+    uint64_t rank = (uint64_t) (zipf->n * pow(zipf->eta * u - zipf->eta + 1.0, zipf->alpha));
+    return rank < zipf->n ? rank : zipf->n - 1;
+}
+
+static inline uint64_t bench_pick(bench_keys_t keys, bench_zipf_t* zipf, uint64_t n)
+{
+    return keys == BENCH_KEYS_ZIPFIAN ? bench_zipf_next(zipf) : bench_rand() % n;
+}
+
+static double bench_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static size_t bench_rss(void)
+{
+    size_t pages = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+
+    if (statm)
+    {
+        if (fscanf(statm, "%*s %zu", &pages) != 1)
+        {
+            pages = 0;
+        }
+
+        fclose(statm);
+    }
+
+    return pages * (size_t) sysconf(_SC_PAGESIZE);
+}
+
+static size_t bench_peak_rss(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (size_t) usage.ru_maxrss * 1024;
+}
+
+static void bench_report(bench_result_t* result)
+{
+    double ns_per_op = result->ops ? result->seconds * 1e9 / result->ops : 0.0;
+    double ops_per_sec = result->seconds > 0.0 ? result->ops / result->seconds : 0.0;
+
+    printf("%s\n    {\"workload\": \"%s\", \"size\": %zu, \"keys\": \"%s\", \"auto_resize\": %s, "
+           "\"hit_ratio\": %.2f, \"read_ratio\": %.2f, \"ops\": %zu, \"ns_per_op\": %.3f, "
+           "\"ops_per_sec\": %.0f, \"bytes_per_entry\": %.2f, \"peak_rss_bytes\": %zu}",
+           bench_first_result ? "" : ",", result->workload, result->size, bench_keys_names[result->keys],
+           result->auto_resize ? "true" : "false", result->hit_ratio, result->read_ratio, result->ops,
+           ns_per_op, ops_per_sec, result->bytes_per_entry, bench_peak_rss());
+    fflush(stdout);
+
+    bench_first_result = false;
+}
+
+static ght_table_t* bench_create(bench_cfg_t* cfg, size_t size, bool auto_resize)
+{
+    ght_cfg_t table_cfg = cfg->table;
+
+    // Without auto_resize the table is sized for the whole run up front.
+    table_cfg.auto_resize = auto_resize ? BENCH_AUTO_RESIZE : 0.0;
+    table_cfg.width = auto_resize ? 0 : (ght_width_t) (size / BENCH_AUTO_RESIZE) + 1;
+
+    ght_table_t* table = ght_create(&table_cfg);
+
+    if (!table)
+    {
+        fprintf(stderr, "ght_bench: ght_create failed for %zu entries\n", size);
+        exit(EXIT_FAILURE);
+    }
+
+    return table;
+}
+
+static void bench_fill(ght_table_t* table, bench_keys_t keys, size_t size, size_t rss, bench_result_t* result)
+{
+    double start = bench_now();
+
+    for (uint64_t i = 0; i < size; i++)
+    {
+        if (ght_insert(table, bench_key(keys, i), i + 1))
+        {
+            fprintf(stderr, "ght_bench: ght_insert failed after %" PRIu64 " entries\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    result->seconds = bench_now() - start;
+    result->ops = size;
+
+    size_t grown = bench_rss();
+    result->bytes_per_entry = grown > rss ? (double) (grown - rss) / size : 0.0;
+}
+
+static void bench_search(ght_table_t* table, bench_cfg_t* cfg, bench_keys_t keys, bench_zipf_t* zipf,
+                         size_t size, double hit_ratio, bench_result_t* result)
+{
+    size_t ops = size < BENCH_MIN_OPS ? BENCH_MIN_OPS : size;
+    ops = ops < cfg->max_ops ? ops : cfg->max_ops;
+
+    // The stream is generated first so neither the RNG nor pow() is timed.
+    ght_key_t* stream = malloc(ops * sizeof(ght_key_t));
+
+    if (!stream)
+    {
+        fprintf(stderr, "ght_bench: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < ops; i++)
+    {
+        uint64_t index = bench_pick(keys, zipf, size);
+
+        // Indices past the inserted range are guaranteed misses.
+        stream[i] = bench_key(keys, bench_rand_double() < hit_ratio ? index : index + size);
+    }
+
+    ght_data_t sink = 0;
+    double start = bench_now();
+
+    for (size_t i = 0; i < ops; i++)
+    {
+        sink += ght_search(table, stream[i]);
+    }
+
+    result->seconds = bench_now() - start;
+    result->ops = ops;
+
+    free(stream);
+
+    // Keeps the loop from being optimized away.
+    if (sink == (ght_data_t) -1)
+    {
+        fputc('\0', stderr);
+    }
+}
+
+static void bench_mixed(ght_table_t* table, bench_cfg_t* cfg, bench_keys_t keys, bench_zipf_t* zipf,
+                        size_t size, double read_ratio, uint64_t* low, bench_result_t* result)
+{
+    size_t ops = size < BENCH_MIN_OPS ? BENCH_MIN_OPS : size;
+    ops = ops < cfg->max_ops ? ops : cfg->max_ops;
+
+    // Each read looks up a live key. Each write retires the oldest key and inserts
+    // a new one, so the load stays at size while the table churns.
+    uint64_t* stream = malloc(ops * sizeof(uint64_t));
+
+    if (!stream)
+    {
+        fprintf(stderr, "ght_bench: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < ops; i++)
+    {
+        stream[i] = bench_rand_double() < read_ratio ? bench_pick(keys, zipf, size) : UINT64_MAX;
+    }
+
+    ght_data_t sink = 0;
+    uint64_t oldest = *low;
+    double start = bench_now();
+
+    for (size_t i = 0; i < ops; i++)
+    {
+        if (stream[i] != UINT64_MAX)
+        {
+            sink += ght_search(table, bench_key(keys, oldest + stream[i]));
+        }
+        else
+        {
+            ght_delete(table, bench_key(keys, oldest));
+            ght_insert(table, bench_key(keys, oldest + size), oldest + size + 1);
+            oldest++;
+        }
+    }
+
+    result->seconds = bench_now() - start;
+    result->ops = ops;
+    *low = oldest;
+
+    free(stream);
+
+    if (sink == (ght_data_t) -1)
+    {
+        fputc('\0', stderr);
+    }
+}
+
+static void bench_resize(ght_table_t* table, bench_result_t* result)
+{
+    ght_width_t width = ght_width(table);
+    double start = bench_now();
+
+    // Grow then shrink back, both moves every entry once.
+    ght_resize(table, width * 2);
+    ght_resize(table, width);
+
+    result->seconds = bench_now() - start;
+    result->ops = 2 * ght_load(table);
+}
+
+static void bench_drain(ght_table_t* table, bench_keys_t keys, size_t size, uint64_t low, bench_result_t* result)
+{
+    double start = bench_now();
+
+    for (uint64_t i = low; i < low + size; i++)
+    {
+        ght_delete(table, bench_key(keys, i));
+    }
+
+    result->seconds = bench_now() - start;
+    result->ops = size;
+}
+
+static void bench_run(bench_cfg_t* cfg, size_t size, bench_keys_t keys, bench_zipf_t* zipf, bool auto_resize)
+{
+    static const double hit_ratios[] = {1.0, 0.5, 0.0};
+    static const double read_ratios[] = {0.95, 0.5};
+
+    bench_result_t result = {.size = size, .keys = keys, .auto_resize = auto_resize};
+    size_t rss = bench_rss();
+    ght_table_t* table = bench_create(cfg, size, auto_resize);
+    uint64_t low = 0;
+
+    result.workload = "insert";
+    bench_fill(table, keys, size, rss, &result);
+    bench_report(&result);
+    result.bytes_per_entry = 0.0;
+
+    result.workload = "search";
+    for (size_t i = 0; i < sizeof(hit_ratios) / sizeof(hit_ratios[0]); i++)
+    {
+        result.hit_ratio = hit_ratios[i];
+        bench_search(table, cfg, keys, zipf, size, hit_ratios[i], &result);
+        bench_report(&result);
+    }
+    result.hit_ratio = 0.0;
+
+    result.workload = "mixed";
+    for (size_t i = 0; i < sizeof(read_ratios) / sizeof(read_ratios[0]); i++)
+    {
+        result.read_ratio = read_ratios[i];
+        bench_mixed(table, cfg, keys, zipf, size, read_ratios[i], &low, &result);
+        bench_report(&result);
+    }
+    result.read_ratio = 0.0;
+
+    result.workload = "resize";
+    bench_resize(table, &result);
+    bench_report(&result);
+
+    result.workload = "delete";
+    bench_drain(table, keys, size, low, &result);
+    bench_report(&result);
+
+    ght_destroy(table);
+
+#if defined(__GLIBC__)
+    // Hand freed pages back so the next bytes_per_entry starts from a clean RSS.
+    malloc_trim(0);
+#endif
+}
+
+static void bench_usage(const char* program)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --min-size N      smallest table size (default 1000)\n"
+            "  --max-size N      largest table size, sizes grow by 10x (default 1000000, up to 100000000)\n"
+            "  --max-ops N       cap on lookups per search or mixed run (default %d)\n"
+            "  --engine NAME     chained | open_addressing | robin_hood | cuckoo\n"
+            "  --index NAME      modulo | pow2 | fastrange | reciprocal\n"
+            "  --node-pool       allocate chained nodes from slabs\n"
+            "  --seed N          random seed\n",
+            program, BENCH_MAX_OPS);
+}
+
+static int bench_lookup(const char* name, const char** names, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!strcmp(name, names[i])) return (int) i;
+    }
+
+    return -1;
+}
+
+int main(int argc, char** argv)
+{
+    bench_cfg_t cfg = {.min_size = 1000, .max_size = 1000000, .max_ops = BENCH_MAX_OPS, .seed = 42};
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        int choice;
+
+        if (!strcmp(argv[i], "--node-pool"))
+        {
+            cfg.table.node_pool = true;
+            continue;
+        }
+
+        if (!value)
+        {
+            bench_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        if (!strcmp(argv[i], "--min-size")) cfg.min_size = strtoull(value, NULL, 10);
+        else if (!strcmp(argv[i], "--max-size")) cfg.max_size = strtoull(value, NULL, 10);
+        else if (!strcmp(argv[i], "--max-ops")) cfg.max_ops = strtoull(value, NULL, 10);
+        else if (!strcmp(argv[i], "--seed")) cfg.seed = strtoull(value, NULL, 10);
+        else if (!strcmp(argv[i], "--engine") && (choice = bench_lookup(value, bench_engine_names, 4)) >= 0)
+        {
+            cfg.table.engine = (ght_engine_t) choice;
+        }
+        else if (!strcmp(argv[i], "--index") && (choice = bench_lookup(value, bench_index_names, 4)) >= 0)
+        {
+            cfg.table.index_policy = (ght_index_policy_t) choice;
+        }
+        else
+        {
+            bench_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        i++;
+    }
+
+    if (!cfg.min_size || cfg.min_size > cfg.max_size || !cfg.max_ops)
+    {
+        bench_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("{\n  \"config\": {\"engine\": \"%s\", \"index_policy\": \"%s\", \"node_pool\": %s, \"seed\": %" PRIu64 "},\n"
+           "  \"results\": [",
+           bench_engine_names[cfg.table.engine], bench_index_names[cfg.table.index_policy],
+           cfg.table.node_pool ? "true" : "false", cfg.seed);
+
+    for (size_t size = cfg.min_size; size <= cfg.max_size; size *= 10)
+    {
+        bench_zipf_t zipf;
+        bench_zipf_init(&zipf, size);
+
+        for (bench_keys_t keys = BENCH_KEYS_UNIFORM; keys <= BENCH_KEYS_ZIPFIAN; keys++)
+        {
+            for (int auto_resize = 1; auto_resize >= 0; auto_resize--)
+            {
+                bench_rng_state = cfg.seed;
+                bench_run(&cfg, size, keys, &zipf, auto_resize);
+            }
+        }
+    }
+
+    printf("\n  ]\n}\n");
+    return EXIT_SUCCESS;
+}
@@ -24,12 +24,86 @@
  * SOFTWARE.
  */
 
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE     // MAP_ANONYMOUS and madvise
+#endif
+
+#include <stdatomic.h>
 #include <stdlib.h>
+#include <string.h>
 #include <threads.h>
+#include <time.h>
+
+// Built on its own or from ght.h in single-header mode, never both.
+#ifndef GHT_IMPLEMENTATION_INCLUDED
+#define GHT_IMPLEMENTATION_INCLUDED
+#endif
+
 #include "ght.h"
 
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define GHT_HAVE_MMAP
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Compiled for the instructions they need and only called once CPUID has reported them.
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+#define GHT_HAVE_X86_DIGESTORS
+#endif
+
 #define GHT_DEFAULT_WIDTH   (100)
 
+#define GHT_OA_GROUP_WIDTH  (16)
+#define GHT_OA_CTRL_EMPTY   ((int8_t) -128)     // 0b10000000
+#define GHT_OA_CTRL_DELETED ((int8_t) -2)       // 0b11111110
+#define GHT_OA_NOT_FOUND    ((ght_index_t) -1)
+#define GHT_RH_MAX_DISTANCE (UINT8_MAX)         // Probe distances are stored plus one in a byte, 0 marks an empty slot.
+#define GHT_CUCKOO_WAYS     (4)                 // Slots per bucket, the keys and data of a bucket fill one cache line.
+#define GHT_CUCKOO_LOCKS    (1024)              // Default number of bucket locks, must be a power of two.
+#define GHT_CUCKOO_DEPTH    (5)                 // Longest displacement path an insert searches for.
+#define GHT_CUCKOO_QUEUE    (256)               // Buckets visited by one displacement path search.
+
+#define GHT_CACHE_LINE      (64)
+#define GHT_SLAB_SIZE       ((size_t) 64 * 1024)    // Must be a power of two, slabs are aligned to their size.
+#define GHT_SLAB_BATCH      (8)                     // Most slabs carved out of one block of the caller's malloc.
+#define GHT_MAGAZINE_SIZE   (32)
+#define GHT_MAGAZINES       (16)                    // Must be a power of two.
+#define GHT_RETIRE_BATCH    (64)                    // Items a thread holds in limbo before it tries to advance the epoch.
+#define GHT_EBR_BAGS        (3)                     // Limbo bags per thread: the current epoch, the previous one and one old enough to free.
+#define GHT_MIGRATE_BUCKETS (4)                     // Non-empty buckets an operation migrates during an incremental resize.
+#define GHT_MIGRATE_EMPTY   (10)                    // Empty buckets skipped per bucket of migration budget.
+#define GHT_TRANSFER_STRIDE (16)                    // Old buckets a thread claims at a time during a cooperative resize.
+#define GHT_FORWARDED       (&_ght_forwarded)       // Old bucket of a cooperative resize whose nodes moved to the new array.
+#define GHT_BATCH           (16)                    // Keys in flight per prefetch stage of ght_search_batch.
+#define GHT_SEED_UNKNOWN    (0)                     // Seed of a caller supplied hash, checked against the key under the lock.
+
+#if SIZE_MAX > UINT32_MAX
+#define GHT_HASH_BITS       (64)
+#define GHT_GOLDEN          ((ght_hash_t) 0x9e3779b97f4a7c15ULL)    // 2^64 / phi
+#else
+#define GHT_HASH_BITS       (32)
+#define GHT_GOLDEN          ((ght_hash_t) 0x9e3779b9UL)             // 2^32 / phi
+#endif
+
+#define GHT_LF_SEGMENTS     (GHT_HASH_BITS + 1)     // Lock-free bucket directory, segment s > 0 doubles the buckets of the segments before it.
+#define GHT_LF_MARK         ((uintptr_t) 1)         // Low bit of a lock-free node's next pointer, set once the node is deleted.
+#define GHT_LF_NEXT(next)   ((ght_bucket_t*) ((uintptr_t) (next) & ~GHT_LF_MARK))
+#define GHT_LF_MARKED(next) ((uintptr_t) (next) & GHT_LF_MARK)
+
+#define GHT_PUBLISH(dst, value) (__atomic_store_n(&(dst), (value), __ATOMIC_RELEASE))
+#define GHT_CONSUME(src)        (__atomic_load_n(&(src), __ATOMIC_ACQUIRE))
+
 #define GHT_MUTEX_CREATE_RECURSIVE(ght) (thrd_success == mtx_init(&ght->mutex, mtx_plain | mtx_recursive))
 #define GHT_MUTEX_DESTROY(ght)          (mtx_destroy(&ght->mutex))
 #define GHT_MUTEX_LOCK(ght)             (mtx_lock(&ght->mutex))
@@ -44,229 +118,785 @@ typedef struct ght_bucket
     ght_bucket_t* next;
 } ght_bucket_t;
 
+typedef struct ght_bytes_bucket
+{
+    ght_bucket_t bucket;        // bucket.key points to a heap copy of the key when it is longer than key_inline.
+    size_t length;
+    uint8_t inline_key[];
+} ght_bytes_bucket_t;
+
+typedef struct ght_slab ght_slab_t;
+typedef struct ght_slab
+{
+    ght_slab_t* next;           // Every slab of the pool.
+    ght_slab_t* next_partial;   // Slabs with at least one node available.
+    ght_slab_t* prev_partial;
+    void* free;                 // Recycled nodes, linked through their first word.
+    size_t live;                // Nodes currently handed out.
+    size_t bump;                // Nodes past this index were never handed out since the slab was last purged.
+    void* block;                // Block of the caller's malloc this slab and the ones carved after it came from.
+    bool partial;
+} ght_slab_t;
+
+typedef struct ght_magazine
+{
+    _Alignas(GHT_CACHE_LINE) atomic_flag lock;
+    size_t count;
+    void* nodes[GHT_MAGAZINE_SIZE];
+} ght_magazine_t;
+
+typedef struct ght_pool
+{
+    mtx_t mutex;                // Guards the slabs once the pool is shared.
+    ght_allocator_t allocator;  // Of the table, mmap and aligned_alloc when it has no functions.
+    size_t node_size;
+    size_t capacity;            // Nodes per slab.
+    ght_slab_t* slabs;
+    ght_slab_t* partial;
+    size_t slab_count;
+    uint8_t* carve;             // Aligned slabs left in the last block of the caller's malloc.
+    size_t carve_left;
+    thrd_t owner;               // First thread to use the pool.
+    atomic_bool shared;         // Set once a second thread uses the pool, enables the magazines.
+    ght_magazine_t* magazines;  // Per-thread caches of free nodes, indexed by thread slot.
+} ght_pool_t;
+
+typedef struct ght_stripe
+{
+    _Alignas(GHT_CACHE_LINE) mtx_t mutex;
+    atomic_size_t load;         // Entries whose hash maps to this stripe.
+} ght_stripe_t;
+
+typedef struct ght_retired
+{
+    ght_table_t* table;
+    void (*reclaim)(ght_table_t* table, void* ptr, size_t size);
+    void* ptr;
+    size_t size;
+} ght_retired_t;
+
+typedef struct ght_limbo
+{
+    ght_retired_t* items;
+    size_t count;
+    size_t capacity;
+    size_t epoch;               // Global epoch the items were retired in.
+    ght_table_t* owner;         // Table whose allocator provided items, which counts them in its pending.
+} ght_limbo_t;
+
+typedef struct ght_ebr_record ght_ebr_record_t;
+typedef struct ght_ebr_record
+{
+    _Alignas(GHT_CACHE_LINE) atomic_size_t state;   // Epoch observed on entry shifted left once, low bit set inside a read section.
+    size_t depth;               // Nested read sections of the owner.
+    atomic_flag lock;           // Guards the bags against a flush from another thread.
+    atomic_bool used;           // Owned by a live thread.
+    size_t count;               // Items in all bags.
+    ght_limbo_t limbo[GHT_EBR_BAGS];
+    ght_ebr_record_t* next;     // Registry link, records are reused but never freed.
+} ght_ebr_record_t;
+
+typedef struct ght_slot
+{
+    ght_key_t key;
+    ght_data_t data;
+} ght_slot_t;
+
+typedef struct ght_cuckoo_bucket
+{
+    ght_key_t keys[GHT_CUCKOO_WAYS];
+    ght_data_t data[GHT_CUCKOO_WAYS];
+} ght_cuckoo_bucket_t;
+
+typedef struct ght_cuckoo
+{
+    ght_cuckoo_bucket_t* buckets;
+    uint32_t* tags;             // One byte per slot of each bucket, the top byte of the hash or 0 when the slot is empty.
+    ght_index_t mask;           // Number of buckets minus one, the number of buckets is a power of two.
+} ght_cuckoo_t;
+
+typedef struct ght_cuckoo_lock
+{
+    _Alignas(GHT_CACHE_LINE) atomic_size_t version;    // Odd while a writer holds the lock.
+    atomic_size_t load;         // Entries whose primary bucket maps to this lock.
+} ght_cuckoo_lock_t;
+
+typedef struct ght_cuckoo_step
+{
+    ght_index_t bucket;
+    ght_index_t from;           // Bucket of the entry that moves here.
+    size_t parent;              // Queue position of the bucket whose entry moves here.
+    unsigned slot;              // Slot of that entry in the parent bucket.
+    unsigned depth;
+} ght_cuckoo_step_t;
+
 typedef struct ght_table
 {
     mtx_t mutex;
     ght_digestor_t digestor;
+    ght_keyed_digestor_t keyed_digestor;    // Replaces digestor when set, hashes with seed.
+    uint64_t seed;                  // Keyed and built-in digestors: only changes with every lock held.
+    size_t reseed_chain;
+    ght_load_t reseed_load;         // Load at the last re-seed, the next one waits until the table has doubled.
     ght_deallocator_t deallocator;
     ght_width_t width;
     ght_load_factor_t auto_resize;
+    ght_load_factor_t auto_shrink;
+    ght_width_t min_width;          // Auto-shrink never goes below the width the table was created with.
     ght_bucket_t** buckets;
     ght_load_t load;
+    ght_engine_t engine;
+    int8_t* ctrl;           // Open addressing: one control byte per slot, EMPTY, DELETED or the low 7 bits of the hash.
+    ght_slot_t* slots;      // Open addressing: key/data pairs, parallel to ctrl.
+    ght_load_t tombstones;  // Open addressing: number of DELETED control bytes.
+    uint8_t* distances;     // Robin Hood: distance of each slot from its home slot plus one, 0 when empty.
+    ght_cuckoo_t* cuckoo;   // Cuckoo: current arrays, replaced by a resize and read without locks.
+    ght_cuckoo_lock_t* locks;   // Cuckoo: bucket b is covered by locks[b & (lock_count - 1)].
+    size_t lock_count;
+    ght_pool_t* pool;       // Chained: node allocator, NULL to use calloc/free.
+    ght_stripe_t* stripes;  // Chained: bucket locks and per-stripe loads, NULL to lock the whole table with mutex.
+    size_t stripe_count;
+    bool read_mostly;       // ght_search takes no lock and unlinked nodes are retired to the epoch reclaimer.
+    atomic_size_t sequence; // Read-mostly: odd while a resize publishes buckets and width.
+    atomic_size_t pending;  // Memory this table retired that no thread has reclaimed yet.
+    ght_resize_mode_t resize_mode;
+    ght_bucket_t** old_buckets;     // Incremental and cooperative: the array being migrated from, NULL when no resize is in progress.
+    ght_width_t old_width;
+    ght_index_t migrated;           // Incremental: old buckets below this index were moved to buckets.
+    atomic_size_t transfer;         // Cooperative: next old bucket a helping thread claims.
+    atomic_size_t transferred;      // Cooperative: old buckets forwarded so far.
+    ght_index_policy_t index_policy;
+    uint64_t magic;                 // Index policy constant for width: the shift for POW2, the reciprocal for RECIPROCAL.
+    uint64_t old_magic;             // Incremental: magic of old_width.
+    ght_key_mode_t key_mode;
+    size_t key_inline;              // Byte keys: longest key stored inside the node.
+    size_t node_size;               // sizeof(ght_bucket_t), or a ght_bytes_bucket_t with its inline key.
+    ght_bytes_digestor_t bytes_digestor;    // NULL for the built-in seeded Murmur64A.
+    ght_comparator_t comparator;
+    ght_allocator_t allocator;      // Every allocation of the table goes through it, even reclaimed ones.
 } ght_table_t;
 
-static ght_hash_t _ght_digestor_murmur3(ght_key_t key);
+typedef struct ght_lf_table
+{
+    ght_table_t table;              // Digestor, deallocator, auto_resize and the count of retired nodes not yet reclaimed.
+    ght_bucket_t** segments[GHT_LF_SEGMENTS];   // Bucket sentinels, segments are allocated when a bucket in them is first used.
+    ght_width_t base;               // Buckets of segment 0, a power of two.
+    unsigned base_bits;
+    atomic_size_t size;             // Buckets in use, a power of two no smaller than base.
+    atomic_size_t load;
+} ght_lf_table_t;
+
+typedef struct ght_sharded
+{
+    ght_allocator_t allocator;
+    ght_table_t** shards;
+    size_t count;                   // A power of two.
+    unsigned bits;                  // log2(count), the hash bits that select a shard.
+} ght_sharded_t;
+
+static atomic_size_t _ght_ebr_epoch;
+static ght_ebr_record_t* _ght_ebr_records;          // Every record ever registered, pushed with a CAS.
+static _Thread_local ght_ebr_record_t* _ght_ebr_self;
+static tss_t _ght_ebr_key;                          // Releases the record of an exiting thread.
+static bool _ght_ebr_key_ready;
+static once_flag _ght_ebr_once = ONCE_FLAG_INIT;
+static ght_bucket_t _ght_forwarded;
+
+static ght_hash_t _ght_digestor_murmur3(ght_key_t key, uint64_t seed);
+static ght_hash_t _ght_digestor_murmur3_bytes(const void* key, size_t length, uint64_t seed);
+static uint64_t _ght_random_seed(void);
+static ght_keyed_digestor_t _ght_builtin_digestor(ght_digest_t digest);
+#ifdef GHT_HAVE_X86_DIGESTORS
+static ght_hash_t _ght_digestor_aes(ght_key_t key, uint64_t seed);
+static ght_hash_t _ght_digestor_crc32c(ght_key_t key, uint64_t seed);
+#endif
+static GHT_FORCE_INLINE ght_hash_t _ght_digest(ght_table_t* table, ght_key_t key);
+static GHT_FORCE_INLINE ght_hash_t _ght_digest_bytes(ght_table_t* table, const void* key, size_t length);
+static GHT_FORCE_INLINE ght_hash_t _ght_digest_key(ght_table_t* table, ght_key_t key, size_t length);
+static GHT_FORCE_INLINE ght_hash_t _ght_digest_seeded(ght_table_t* table, ght_key_t key, size_t length, uint64_t seed);
+static GHT_FORCE_INLINE uint64_t _ght_seed(ght_table_t* table);
+static ght_status_t _ght_reseed(ght_table_t* table, uint64_t seed);
+static bool _ght_comparator_memcmp(const void* a, const void* b, size_t length);
 static GHT_FORCE_INLINE uint32_t _ght_digestor_murmur3_32(ght_key_t key, uint32_t seed);
 static GHT_FORCE_INLINE uint64_t _ght_digestor_murmur3_64(ght_key_t key, uint64_t seed);
-static void _ght_delete_recursive(ght_bucket_t* bucket, ght_load_t* load, ght_deallocator_t deallocator);
+static void _ght_delete_recursive(ght_table_t* table, ght_bucket_t* bucket);
+static ght_status_t _ght_insert(ght_table_t* table, ght_hash_t hash, uint64_t seed, ght_key_t key, size_t length, ght_data_t data);
+static ght_data_t _ght_search(ght_table_t* table, ght_hash_t hash, uint64_t seed, ght_key_t key, size_t length);
+static ght_status_t _ght_delete(ght_table_t* table, ght_hash_t hash, uint64_t seed, ght_key_t key, size_t length);
 static void _ght_move_recursive(ght_bucket_t* bucket, ght_load_t* moved, ght_table_t* to_table);
+static ght_status_t _ght_oa_alloc(ght_table_t* table, ght_width_t width);
+static ght_status_t _ght_oa_rehash(ght_table_t* table, ght_width_t width);
+static void _ght_oa_destroy(ght_table_t* table);
+static ght_status_t _ght_oa_insert(ght_table_t* table, ght_hash_t hash, ght_key_t key, ght_data_t data);
+static ght_data_t _ght_oa_search(ght_table_t* table, ght_hash_t hash, ght_key_t key);
+static size_t _ght_oa_search_batch(ght_table_t* table, const ght_key_t* keys, ght_data_t* data, bool* found, size_t count);
+static ght_status_t _ght_oa_delete(ght_table_t* table, ght_hash_t hash, ght_key_t key);
+static ght_status_t _ght_rh_alloc(ght_table_t* table, ght_width_t width);
+static ght_status_t _ght_rh_rehash(ght_table_t* table, ght_width_t width);
+static void _ght_rh_destroy(ght_table_t* table);
+static ght_status_t _ght_rh_insert(ght_table_t* table, ght_hash_t hash, ght_key_t key, ght_data_t data);
+static ght_data_t _ght_rh_search(ght_table_t* table, ght_hash_t hash, ght_key_t key);
+static size_t _ght_rh_search_batch(ght_table_t* table, const ght_key_t* keys, ght_data_t* data, bool* found, size_t count);
+static ght_status_t _ght_rh_delete(ght_table_t* table, ght_hash_t hash, ght_key_t key);
+static ght_status_t _ght_cuckoo_create(ght_table_t* table, ght_width_t width, size_t lock_count);
+static void _ght_cuckoo_destroy(ght_table_t* table);
+static ght_status_t _ght_cuckoo_resize(ght_table_t* table, ght_width_t expected, ght_width_t width);
+static ght_status_t _ght_cuckoo_insert(ght_table_t* table, ght_hash_t hash, ght_key_t key, ght_data_t data);
+static ght_data_t _ght_cuckoo_search(ght_table_t* table, ght_hash_t hash, ght_key_t key);
+static size_t _ght_cuckoo_search_batch(ght_table_t* table, const ght_key_t* keys, ght_data_t* data, bool* found, size_t count);
+static ght_status_t _ght_cuckoo_delete(ght_table_t* table, ght_hash_t hash, ght_key_t key);
+static void _ght_reclaim_cuckoo(ght_table_t* table, void* ptr, size_t size);
+static void _ght_cuckoo_free(ght_table_t* table, ght_cuckoo_t* cuckoo);
+static GHT_FORCE_INLINE ght_hash_t _ght_lf_reverse(ght_hash_t hash);
+static bool _ght_lf_find(ght_lf_table_t* lf, ght_bucket_t* head, ght_hash_t order, ght_key_t key, ght_bucket_t*** prev, ght_bucket_t** curr);
+static ght_bucket_t* _ght_lf_head(ght_lf_table_t* lf, ght_hash_t hash, bool create);
+static GHT_FORCE_INLINE ght_table_t* _ght_shard(ght_sharded_t* sharded, ght_hash_t hash);
+static ght_status_t _ght_rehash(ght_table_t* table, ght_width_t width);
+static ght_status_t _ght_auto_resize(ght_table_t* table, ght_width_t width, ght_width_t new_width);
+static ght_width_t _ght_reserve_width(ght_table_t* table, ght_load_t count);
+static ght_status_t _ght_bulk_insert(ght_table_t* table, const ght_key_t* keys, const ght_data_t* data, size_t count);
+static GHT_FORCE_INLINE ght_stripe_t* _ght_stripe(ght_table_t* table, ght_hash_t hash);
+static GHT_FORCE_INLINE ght_width_t _ght_round_width(ght_table_t* table, ght_width_t width);
+static GHT_FORCE_INLINE ght_index_t _ght_index(ght_index_policy_t policy, ght_hash_t hash, ght_width_t width, uint64_t magic);
+static uint64_t _ght_index_magic(ght_index_policy_t policy, ght_width_t width);
+static GHT_FORCE_INLINE mtx_t* _ght_lock(ght_table_t* table, ght_hash_t hash);
+static GHT_FORCE_INLINE mtx_t* _ght_lock_key(ght_table_t* table, ght_hash_t* hash, uint64_t* seed, ght_key_t key, size_t length);
+static void _ght_lock_all(ght_table_t* table);
+static void _ght_unlock_all(ght_table_t* table);
+static GHT_FORCE_INLINE void _ght_load_add(ght_table_t* table, ght_hash_t hash, ptrdiff_t delta);
+static ght_load_t _ght_load_sum(ght_table_t* table);
+static GHT_FORCE_INLINE ght_load_t _ght_load_estimate(ght_table_t* table, ght_hash_t hash);
+static GHT_FORCE_INLINE bool _ght_should_grow(ght_table_t* table, ght_hash_t hash);
+static GHT_FORCE_INLINE bool _ght_should_shrink(ght_table_t* table, ght_load_t load);
+static GHT_FORCE_INLINE ght_bucket_t** _ght_chain(ght_table_t* table, ght_hash_t hash);
+static void _ght_migrate(ght_table_t* table, size_t count);
+static GHT_FORCE_INLINE mtx_t* _ght_bucket_lock(ght_table_t* table, ght_index_t index, ght_width_t width);
+static bool _ght_transfer_bucket(ght_table_t* table, ght_index_t index);
+static void _ght_transfer_all(ght_table_t* table);
+static void _ght_transfer_help(ght_table_t* table, size_t strides);
+static size_t _ght_thread_slot(void);
+static GHT_FORCE_INLINE ght_bucket_t* _ght_bucket_alloc(ght_table_t* table);
+static GHT_FORCE_INLINE void _ght_bucket_free(ght_table_t* table, ght_bucket_t* bucket);
+static GHT_FORCE_INLINE void _ght_bucket_release(ght_table_t* table, ght_bucket_t* bucket);
+static GHT_FORCE_INLINE ght_status_t _ght_bucket_set_key(ght_table_t* table, ght_bucket_t* bucket, ght_key_t key, size_t length);
+static GHT_FORCE_INLINE ght_key_t _ght_bucket_key(ght_table_t* table, ght_bucket_t* bucket);
+static GHT_FORCE_INLINE bool _ght_match(ght_table_t* table, ght_bucket_t* bucket, ght_hash_t hash, ght_key_t key, size_t length);
+static ght_ebr_record_t* _ght_ebr_register(void);
+static void _ght_ebr_release(void* ptr);
+static GHT_FORCE_INLINE ght_ebr_record_t* _ght_ebr_enter(void);
+static GHT_FORCE_INLINE void _ght_ebr_exit(ght_ebr_record_t* record);
+static void _ght_ebr_retire(ght_table_t* table, void (*reclaim)(ght_table_t*, void*, size_t), void* ptr, size_t size);
+static bool _ght_ebr_move_items(ght_limbo_t* limbo, ght_table_t* table, size_t capacity);
+static void _ght_ebr_free_items(ght_limbo_t* limbo);
+static void _ght_ebr_collect(void);
+static void _ght_ebr_drain(void);
+static void _ght_ebr_flush(ght_table_t* table);
+static ght_data_t _ght_rcu_search(ght_table_t* table, ght_hash_t hash, ght_key_t key, size_t length);
+static size_t _ght_rcu_search_batch(ght_table_t* table, const ght_key_t* keys, ght_data_t* data, bool* found, size_t count);
+static ght_status_t _ght_rcu_rehash(ght_table_t* table, ght_width_t width);
+static void _ght_reclaim_bucket(ght_table_t* table, void* ptr, size_t size);
+static void _ght_reclaim_replaced(ght_table_t* table, void* ptr, size_t size);
+static void _ght_reclaim_chains(ght_table_t* table, void* ptr, size_t size);
+static ght_stripe_t* _ght_stripes_create(const ght_allocator_t* allocator, size_t count);
+static void _ght_stripes_destroy(const ght_allocator_t* allocator, ght_stripe_t* stripes, size_t count);
+static ght_pool_t* _ght_pool_create(const ght_allocator_t* allocator, size_t node_size, bool shared);
+static void _ght_pool_destroy(ght_pool_t* pool);
+static void* _ght_pool_alloc(ght_pool_t* pool);
+static void _ght_pool_free(ght_pool_t* pool, void* node);
+static bool _ght_allocator_valid(const ght_allocator_t* allocator);
+static GHT_FORCE_INLINE void* _ght_malloc(const ght_allocator_t* allocator, size_t size);
+static GHT_FORCE_INLINE void* _ght_calloc(const ght_allocator_t* allocator, size_t count, size_t size);
+static GHT_FORCE_INLINE void _ght_free(const ght_allocator_t* allocator, void* ptr);
+static void* _ght_aligned_alloc(const ght_allocator_t* allocator, size_t alignment, size_t size);
+static void _ght_aligned_free(const ght_allocator_t* allocator, void* ptr);
 
 #define GHT_DIGESTOR_MURMUR3(key, seed) _Generic((key), \
         uint64_t: _ght_digestor_murmur3_64,             \
         default: _ght_digestor_murmur3_32               \
         )(key, seed)
 
-ght_table_t* ght_create(ght_cfg_t* cfg)
+GHT_API ght_table_t* ght_create(ght_cfg_t* cfg)
 {
     ght_digestor_t digestor;
+    ght_keyed_digestor_t keyed_digestor;
+    uint64_t seed;
+    size_t reseed_chain;
     ght_deallocator_t deallocator;
     ght_width_t width;
     ght_load_factor_t auto_resize;
+    ght_load_factor_t auto_shrink;
+    ght_engine_t engine;
+    bool node_pool;
+    size_t lock_stripes;
+    bool read_mostly;
+    ght_resize_mode_t resize_mode;
+    ght_index_policy_t index_policy;
+    ght_key_mode_t key_mode;
+    size_t key_inline;
+    ght_bytes_digestor_t bytes_digestor;
+    ght_comparator_t comparator;
+    ght_allocator_t allocator;
 
     if (cfg)
     {
-        digestor = cfg->digestor ? cfg->digestor : _ght_digestor_murmur3;
+        digestor = cfg->digestor;
+        keyed_digestor = cfg->keyed_digestor || cfg->digestor ? cfg->keyed_digestor : _ght_builtin_digestor(cfg->digest);
+        seed = cfg->seed;
+        reseed_chain = cfg->reseed_chain;
         deallocator = cfg->deallocator;
         width = cfg->width ? cfg->width : GHT_DEFAULT_WIDTH;
         auto_resize = cfg->auto_resize;
+        auto_shrink = cfg->auto_shrink;
+        engine = cfg->engine;
+        node_pool = cfg->node_pool;
+        lock_stripes = cfg->lock_stripes;
+        read_mostly = cfg->read_mostly;
+        resize_mode = cfg->resize_mode;
+        index_policy = cfg->index_policy;
+        key_mode = cfg->key_mode;
+        key_inline = cfg->key_inline;
+        bytes_digestor = cfg->bytes_digestor;
+        comparator = cfg->comparator ? cfg->comparator : _ght_comparator_memcmp;
+        allocator = cfg->allocator;
     }
     else
     {
-        digestor = _ght_digestor_murmur3;
+        digestor = NULL;
+        keyed_digestor = _ght_builtin_digestor(GHT_DIGEST_AUTO);
+        seed = 0;
+        reseed_chain = 0;
         deallocator = NULL;
         width = GHT_DEFAULT_WIDTH;
         auto_resize = 0.0;
+        auto_shrink = 0.0;
+        engine = GHT_ENGINE_CHAINED;
+        node_pool = false;
+        lock_stripes = 0;
+        read_mostly = false;
+        resize_mode = GHT_RESIZE_BLOCKING;
+        index_policy = GHT_INDEX_MODULO;
+        key_mode = GHT_KEY_INTEGER;
+        key_inline = 0;
+        bytes_digestor = NULL;
+        comparator = _ght_comparator_memcmp;
+        allocator = (ght_allocator_t) {0};
     }
     
-    ght_table_t* table = calloc(1, sizeof(ght_table_t));
+    // Open addressing probes across buckets, neither a bucket lock nor a node publication covers a probe sequence.
+    if ((lock_stripes || read_mostly) && (engine == GHT_ENGINE_OPEN_ADDRESSING || engine == GHT_ENGINE_ROBIN_HOOD)) return NULL;
+    if (key_mode == GHT_KEY_BYTES && engine != GHT_ENGINE_CHAINED) return NULL;
+    
+    // Migration steps rewrite chains of any stripe and would strand lock-free readers on the old array.
+    if (resize_mode == GHT_RESIZE_INCREMENTAL && (lock_stripes || read_mostly || engine != GHT_ENGINE_CHAINED)) return NULL;
+    if (resize_mode == GHT_RESIZE_COOPERATIVE && (read_mostly || engine != GHT_ENGINE_CHAINED)) return NULL;
+    
+    // Re-seeding only helps a digestor that takes the seed, and lock-free readers would hash with a seed the buckets don't match yet.
+    if (reseed_chain && (engine != GHT_ENGINE_CHAINED || read_mostly || (key_mode == GHT_KEY_BYTES ? bytes_digestor != NULL : !keyed_digestor))) return NULL;
+    
+    // Growing halves the load factor and shrinking doubles it, so neither may land past the other threshold.
+    if (auto_shrink > 0.0 && auto_resize > 0.0 && auto_shrink * 2 >= auto_resize) return NULL;
+    if (!_ght_allocator_valid(&allocator)) return NULL;
+    
+    ght_table_t* table = _ght_calloc(&allocator, 1, sizeof(ght_table_t));
 
     if (table)
     {
         if (!GHT_MUTEX_CREATE_RECURSIVE(table))
         {
-            free(table);
+            _ght_free(&allocator, table);
             return NULL;
         }
 
-        table->buckets = calloc(width, sizeof(ght_bucket_t*));
+        table->allocator = allocator;
         table->digestor = digestor;
+        table->keyed_digestor = keyed_digestor;
+        table->seed = seed ? seed : _ght_random_seed();
+        table->reseed_chain = reseed_chain;
         table->deallocator = deallocator;
         table->width = width;
         table->auto_resize = auto_resize;
+        table->auto_shrink = auto_shrink;
+        table->engine = engine;
+        table->resize_mode = resize_mode;
+        table->index_policy = index_policy;
+        table->key_mode = key_mode;
+        table->key_inline = key_mode == GHT_KEY_BYTES ? key_inline : 0;
+        table->node_size = key_mode == GHT_KEY_BYTES ? sizeof(ght_bytes_bucket_t) + key_inline : sizeof(ght_bucket_t);
+        table->bytes_digestor = bytes_digestor;
+        table->comparator = comparator;
+
+        if (engine == GHT_ENGINE_CUCKOO)
+        {
+            // Lookups never lock, so read_mostly changes nothing here.
+            if (_ght_cuckoo_create(table, width, lock_stripes))
+            {
+                ght_destroy(table);
+                return NULL;
+            }
+        }
+        else if (engine != GHT_ENGINE_CHAINED)
+        {
+            if (engine == GHT_ENGINE_OPEN_ADDRESSING ? _ght_oa_alloc(table, width) : _ght_rh_alloc(table, width))
+            {
+                GHT_MUTEX_DESTROY(table);
+                _ght_free(&allocator, table);
+                return NULL;
+            }
+        }
+        else
+        {
+            if (lock_stripes)
+            {
+                table->stripe_count = 1;
+                
+                while (table->stripe_count < lock_stripes)
+                {
+                    table->stripe_count <<= 1;
+                }
+                
+                table->stripes = _ght_stripes_create(&allocator, table->stripe_count);
+            }
+            
+            table->width = _ght_round_width(table, width);
+            table->magic = _ght_index_magic(index_policy, table->width);
+            
+            // Reclamation frees nodes outside of any table lock, so a read-mostly pool is shared from the start.
+            table->buckets = _ght_calloc(&allocator, table->width, sizeof(ght_bucket_t*));
+            table->pool = node_pool ? _ght_pool_create(&allocator, table->node_size, table->stripes || read_mostly) : NULL;
+            table->read_mostly = read_mostly;
+
+            if (!table->buckets || (lock_stripes && !table->stripes) || (node_pool && !table->pool))
+            {
+                ght_destroy(table);
+                return NULL;
+            }
+        }
+        
+        table->min_width = table->width;
     }
     
     return table;
 }
 
-ght_status_t ght_destroy(ght_table_t* table)
+GHT_API ght_table_t* ght_create_from_arrays(ght_cfg_t* cfg, const ght_key_t* keys, const ght_data_t* data, size_t count)
 {
-    if (!table) return -1;
+    if ((cfg && cfg->key_mode == GHT_KEY_BYTES) || ((!keys || !data) && count)) return NULL;
+    
+    // Without a configuration the nodes come from the pool, allocated slab by slab instead of one at a time.
+    ght_cfg_t bulk = cfg ? *cfg : (ght_cfg_t) {.node_pool = true};
     
-    for (ght_load_t i = 0; table->load && (i < table->width); i++)
+    ght_table_t* table = ght_create(&bulk);
+    
+    if (!table) return NULL;
+    
+    ght_status_t status = ght_reserve(table, count);
+    
+    // Nothing else sees the table yet, so a migration the reserve started completes right away.
+    if (table->resize_mode == GHT_RESIZE_COOPERATIVE)
     {
-        _ght_delete_recursive(table->buckets[i], &table->load, table->deallocator);
-        table->buckets[i] = NULL;
+        _ght_transfer_all(table);
     }
     
-    free(table->buckets);
-    table->buckets = NULL;
-
-    GHT_MUTEX_DESTROY(table);
-    free(table);
+    while (table->old_buckets)
+    {
+        _ght_migrate(table, table->old_width);
+    }
     
-    return 0;
+    if (!status)
+    {
+        if (table->engine == GHT_ENGINE_CHAINED)
+        {
+            status = _ght_bulk_insert(table, keys, data, count);
+        }
+        else
+        {
+            for (size_t i = 0; !status && i < count; i++)
+            {
+                status = ght_insert(table, keys[i], data[i]);
+            }
+        }
+    }
+    
+    if (status)
+    {
+        // The caller still owns the data of a failed build.
+        table->deallocator = NULL;
+        ght_destroy(table);
+        return NULL;
+    }
+    
+    return table;
 }
 
-ght_status_t ght_insert(ght_table_t* table, ght_key_t key, ght_data_t data)
+GHT_API ght_status_t ght_destroy(ght_table_t* table)
 {
     if (!table) return -1;
-    GHT_MUTEX_LOCK(table);
-
-    ght_index_t index = table->digestor(key) % table->width;
-    ght_bucket_t* bucket = table->buckets[index];
-    ght_bucket_t* prev = NULL;
     
-    while (bucket && (key != bucket->key))
-    {
-        prev = bucket;
-        bucket = bucket->next;
-    }
+    ght_allocator_t allocator = table->allocator;
 
-    if (bucket)
+    if (table->engine != GHT_ENGINE_CHAINED)
     {
-        if (table->deallocator)
+        if (table->engine == GHT_ENGINE_OPEN_ADDRESSING)
         {
-            table->deallocator(bucket->key, bucket->data);
+            _ght_oa_destroy(table);
         }
-
-        bucket->data = data;
-        
-        if (prev)
+        else if (table->engine == GHT_ENGINE_ROBIN_HOOD)
         {
-            prev->next = bucket->next;
-            bucket->next = table->buckets[index];
-            table->buckets[index] = bucket;
+            _ght_rh_destroy(table);
+        }
+        else
+        {
+            _ght_cuckoo_destroy(table);
         }
         
-        GHT_MUTEX_UNLOCK(table);
+        GHT_MUTEX_DESTROY(table);
+        _ght_free(&allocator, table);
         return 0;
     }
-
-    bucket = calloc(1, sizeof(ght_bucket_t));
-
-    if (!bucket)
+    
+    if (table->read_mostly)
     {
-        GHT_MUTEX_UNLOCK(table);
-        return -1;
+        _ght_ebr_flush(table);
     }
     
-    if (table->auto_resize > 0.0 && (ght_load_factor_t) (table->load + 1)/(ght_load_factor_t) table->width > table->auto_resize)
+    if (table->resize_mode == GHT_RESIZE_COOPERATIVE)
     {
-        ght_resize(table, table->width * 2);
+        _ght_transfer_all(table);
     }
     
-    bucket->key = key;
-    bucket->data = data;
+    while (table->old_buckets)
+    {
+        _ght_migrate(table, table->old_width);
+    }
+    
+    if (table->stripes)
+    {
+        table->load = _ght_load_sum(table);
+        _ght_stripes_destroy(&allocator, table->stripes, table->stripe_count);
+        table->stripes = NULL;
+    }
+    
+    for (ght_load_t i = 0; table->buckets && table->load && (i < table->width); i++)
+    {
+        _ght_delete_recursive(table, table->buckets[i]);
+        table->buckets[i] = NULL;
+    }
     
-    bucket->hash = table->digestor(key);
-    index = bucket->hash % table->width;
-    bucket->next = table->buckets[index];
-    table->buckets[index] = bucket;
-    table->load++; 
+    _ght_free(&allocator, table->buckets);
+    table->buckets = NULL;
+    
+    if (table->pool)
+    {
+        _ght_pool_destroy(table->pool);
+        table->pool = NULL;
+    }
+
+    GHT_MUTEX_DESTROY(table);
+    _ght_free(&allocator, table);
     
-    GHT_MUTEX_UNLOCK(table);
     return 0;
 }
 
-ght_data_t ght_search(ght_table_t* table, ght_key_t key)
+GHT_API ght_status_t ght_insert(ght_table_t* table, ght_key_t key, ght_data_t data)
 {
-    if (!table) return 0;
-    GHT_MUTEX_LOCK(table);
+    if (!table || table->key_mode == GHT_KEY_BYTES) return -1;
     
-    ght_index_t index = table->digestor(key) % table->width;
-    ght_bucket_t* bucket = table->buckets[index];
-    ght_bucket_t* prev = NULL;
+    if (table->engine != GHT_ENGINE_CHAINED) return ght_insert_hashed(table, _ght_digest(table, key), key, data);
     
-    while (bucket && (key != bucket->key))
-    {
-        prev = bucket;
-        bucket = bucket->next;
-    }
+    uint64_t seed = _ght_seed(table);
     
-    if (!bucket)
-    {
-        GHT_MUTEX_UNLOCK(table);
-        return 0;
-    }
+    return _ght_insert(table, _ght_digest_seeded(table, key, 0, seed), seed, key, 0, data);
+}
 
-    if (prev)
-    {
-        prev->next = bucket->next;
-        bucket->next = table->buckets[index];
-        table->buckets[index] = bucket;
-    }
+GHT_API ght_status_t ght_insert_hashed(ght_table_t* table, ght_hash_t hash, ght_key_t key, ght_data_t data)
+{
+    if (!table || table->key_mode == GHT_KEY_BYTES) return -1;
+    if (table->engine == GHT_ENGINE_OPEN_ADDRESSING) return _ght_oa_insert(table, hash, key, data);
+    if (table->engine == GHT_ENGINE_ROBIN_HOOD) return _ght_rh_insert(table, hash, key, data);
+    if (table->engine == GHT_ENGINE_CUCKOO) return _ght_cuckoo_insert(table, hash, key, data);
     
-    ght_data_t data = bucket->data;
+    return _ght_insert(table, hash, GHT_SEED_UNKNOWN, key, 0, data);
+}
 
-    GHT_MUTEX_UNLOCK(table);
-    return data;
+GHT_API ght_status_t ght_insert_bytes(ght_table_t* table, const void* key, size_t length, ght_data_t data)
+{
+    if (!table || table->key_mode != GHT_KEY_BYTES || (!key && length)) return -1;
+    
+    uint64_t seed = _ght_seed(table);
+    
+    return _ght_insert(table, _ght_digest_seeded(table, (ght_key_t) key, length, seed), seed, (ght_key_t) key, length, data);
 }
 
-ght_status_t ght_delete(ght_table_t* table, ght_key_t key)
+GHT_API ght_data_t ght_search(ght_table_t* table, ght_key_t key)
 {
-    if (!table) return -1;
-    GHT_MUTEX_LOCK(table);
+    if (!table || table->key_mode == GHT_KEY_BYTES) return 0;
     
-    ght_index_t index = table->digestor(key) % table->width;
-    ght_bucket_t* bucket = table->buckets[index];
-    ght_bucket_t* prev = NULL;
+    if (table->engine != GHT_ENGINE_CHAINED) return ght_search_hashed(table, _ght_digest(table, key), key);
     
-    while (bucket && (key != bucket->key))
-    {
-        prev = bucket;
-        bucket = bucket->next;
-    }
+    uint64_t seed = _ght_seed(table);
     
-    if (!bucket)
+    return _ght_search(table, _ght_digest_seeded(table, key, 0, seed), seed, key, 0);
+}
+
+GHT_API ght_data_t ght_search_hashed(ght_table_t* table, ght_hash_t hash, ght_key_t key)
+{
+    if (!table || table->key_mode == GHT_KEY_BYTES) return 0;
+    if (table->engine == GHT_ENGINE_OPEN_ADDRESSING) return _ght_oa_search(table, hash, key);
+    if (table->engine == GHT_ENGINE_ROBIN_HOOD) return _ght_rh_search(table, hash, key);
+    if (table->engine == GHT_ENGINE_CUCKOO) return _ght_cuckoo_search(table, hash, key);
+    
+    return _ght_search(table, hash, GHT_SEED_UNKNOWN, key, 0);
+}
+
+GHT_API ght_data_t ght_search_bytes(ght_table_t* table, const void* key, size_t length)
+{
+    if (!table || table->key_mode != GHT_KEY_BYTES || (!key && length)) return 0;
+    
+    uint64_t seed = _ght_seed(table);
+    
+    return _ght_search(table, _ght_digest_seeded(table, (ght_key_t) key, length, seed), seed, (ght_key_t) key, length);
+}
+
+GHT_API size_t ght_search_batch(ght_table_t* table, const ght_key_t* keys, ght_data_t* data, bool* found, size_t count)
+{
+    if (!table || !keys || !data) return 0;
+    
+    if (table->key_mode == GHT_KEY_BYTES)
     {
-        GHT_MUTEX_UNLOCK(table);
-        return -1;
+        memset(data, 0, count * sizeof(ght_data_t));
+        if (found) memset(found, 0, count * sizeof(bool));
+        return 0;
     }
 
-    if (prev)
+    if (table->engine == GHT_ENGINE_OPEN_ADDRESSING) return _ght_oa_search_batch(table, keys, data, found, count);
+    if (table->engine == GHT_ENGINE_ROBIN_HOOD) return _ght_rh_search_batch(table, keys, data, found, count);
+    if (table->engine == GHT_ENGINE_CUCKOO) return _ght_cuckoo_search_batch(table, keys, data, found, count);
+    if (table->read_mostly) return _ght_rcu_search_batch(table, keys, data, found, count);
+    
+    size_t hits = 0;
+    
+    if (!table->stripes)
     {
-        prev->next = bucket->next;
+        GHT_MUTEX_LOCK(table);
+        
+        if (table->old_buckets && table->resize_mode == GHT_RESIZE_INCREMENTAL)
+        {
+            _ght_migrate(table, GHT_MIGRATE_BUCKETS);
+        }
     }
-    else
+    
+    for (size_t base = 0; base < count; base += GHT_BATCH)
     {
-        table->buckets[index] = bucket->next;
+        size_t batch = count - base < GHT_BATCH ? count - base : GHT_BATCH;
+        const ght_key_t* batch_keys = keys + base;
+        ght_hash_t hashes[GHT_BATCH];
+        ght_bucket_t** heads[GHT_BATCH];
+        ght_bucket_t* buckets[GHT_BATCH];
+        uint64_t seed = _ght_seed(table);
+        
+        for (size_t i = 0; i < batch; i++)
+        {
+            hashes[i] = _ght_digest_seeded(table, batch_keys[i], 0, seed);
+        }
+        
+        if (table->stripes)
+        {
+            // Each key needs its own stripe, only the hashing is batched.
+            for (size_t i = 0; i < batch; i++)
+            {
+                mtx_t* mutex = _ght_lock_key(table, &hashes[i], &seed, batch_keys[i], 0);
+                ght_bucket_t* bucket = *_ght_chain(table, hashes[i]);
+                
+                while (bucket && (batch_keys[i] != bucket->key))
+                {
+                    bucket = bucket->next;
+                }
+                
+                data[base + i] = bucket ? bucket->data : 0;
+                mtx_unlock(mutex);
+                
+                hits += bucket != NULL;
+                if (found) found[base + i] = bucket != NULL;
+            }
+            
+            continue;
+        }
+        
+        // Stage 1: fetch the bucket heads, stage 2: fetch the first nodes, stage 3: walk the chains.
+        for (size_t i = 0; i < batch; i++)
+        {
+            heads[i] = _ght_chain(table, hashes[i]);
+            __builtin_prefetch(heads[i]);
+        }
+        
+        for (size_t i = 0; i < batch; i++)
+        {
+            buckets[i] = *heads[i];
+            
+            if (buckets[i])
+            {
+                __builtin_prefetch(buckets[i]);
+            }
+        }
+        
+        for (size_t i = 0; i < batch; i++)
+        {
+            ght_bucket_t* bucket = buckets[i];
+            
+            while (bucket && (batch_keys[i] != bucket->key))
+            {
+                bucket = bucket->next;
+            }
+            
+            data[base + i] = bucket ? bucket->data : 0;
+            
+            hits += bucket != NULL;
+            if (found) found[base + i] = bucket != NULL;
+        }
     }
     
-    if (table->deallocator)
+    if (!table->stripes)
     {
-        table->deallocator(bucket->key, bucket->data);
+        GHT_MUTEX_UNLOCK(table);
     }
     
-    free(bucket);
-    table->load--;
+    return hits;
+}
+
+GHT_API ght_status_t ght_delete(ght_table_t* table, ght_key_t key)
+{
+    if (!table || table->key_mode == GHT_KEY_BYTES) return -1;
     
-    GHT_MUTEX_UNLOCK(table);
-    return 0;
+    if (table->engine != GHT_ENGINE_CHAINED) return ght_delete_hashed(table, _ght_digest(table, key), key);
+    
+    uint64_t seed = _ght_seed(table);
+    
+    return _ght_delete(table, _ght_digest_seeded(table, key, 0, seed), seed, key, 0);
+}
+
+GHT_API ght_status_t ght_delete_hashed(ght_table_t* table, ght_hash_t hash, ght_key_t key)
+{
+    if (!table || table->key_mode == GHT_KEY_BYTES) return -1;
+    if (table->engine == GHT_ENGINE_OPEN_ADDRESSING) return _ght_oa_delete(table, hash, key);
+    if (table->engine == GHT_ENGINE_ROBIN_HOOD) return _ght_rh_delete(table, hash, key);
+    if (table->engine == GHT_ENGINE_CUCKOO) return _ght_cuckoo_delete(table, hash, key);
+    
+    return _ght_delete(table, hash, GHT_SEED_UNKNOWN, key, 0);
+}
+
+GHT_API ght_status_t ght_delete_bytes(ght_table_t* table, const void* key, size_t length)
+{
+    if (!table || table->key_mode != GHT_KEY_BYTES || (!key && length)) return -1;
+    
+    uint64_t seed = _ght_seed(table);
+    
+    return _ght_delete(table, _ght_digest_seeded(table, (ght_key_t) key, length, seed), seed, (ght_key_t) key, length);
 }
 
-ght_load_t ght_load(ght_table_t* table)
+GHT_API ght_load_t ght_load(ght_table_t* table)
 {
     if (!table) return 0;
+    if (table->stripes || table->locks) return _ght_load_sum(table);
     GHT_MUTEX_LOCK(table);
 
     ght_load_t load = table->load;
@@ -275,9 +905,10 @@ ght_load_t ght_load(ght_table_t* table)
     return load;
 }
 
-ght_width_t ght_width(ght_table_t* table)
+GHT_API ght_width_t ght_width(ght_table_t* table)
 {
     if (!table) return 0;
+    if (table->stripes || table->locks) return __atomic_load_n(&table->width, __ATOMIC_RELAXED);
     GHT_MUTEX_LOCK(table);
 
     ght_width_t width = table->width;
@@ -286,9 +917,15 @@ ght_width_t ght_width(ght_table_t* table)
     return width;
 }
 
-ght_load_factor_t ght_load_factor(ght_table_t* table)
+GHT_API ght_load_factor_t ght_load_factor(ght_table_t* table)
 {
     if (!table) return 0.0;
+    
+    if (table->stripes || table->locks)
+    {
+        return (ght_load_factor_t) _ght_load_sum(table) / (ght_load_factor_t) ght_width(table);
+    }
+    
     GHT_MUTEX_LOCK(table);
 
     if (table->width == 0)
@@ -303,126 +940,4144 @@ ght_load_factor_t ght_load_factor(ght_table_t* table)
     return load_factor;
 }
 
-ght_status_t ght_resize(ght_table_t* table, ght_width_t width)
+GHT_API ght_status_t ght_resize(ght_table_t* table, ght_width_t width)
 {
     if (!table || !width) return -1;
-    GHT_MUTEX_LOCK(table);
-    
-    ght_cfg_t cfg = {
-                        .digestor = table->digestor,
-                        .deallocator = table->deallocator,
-                        .width = width,
-                        .auto_resize = 0.0
-                    };
+    if (table->engine == GHT_ENGINE_CUCKOO) return _ght_cuckoo_resize(table, 0, width);
+    _ght_lock_all(table);
 
-    ght_table_t* new = ght_create(&cfg);
+    ght_status_t status;
     
-    ght_load_t moved = 0;
-    for (ght_load_t i = 0; moved < table->load && i < table->width; i++)
+    switch (table->engine)
     {
-        _ght_move_recursive(table->buckets[i], &moved, new);
+        case GHT_ENGINE_OPEN_ADDRESSING:
+            status = _ght_oa_rehash(table, width);
+            break;
+        
+        case GHT_ENGINE_ROBIN_HOOD:
+            status = _ght_rh_rehash(table, width);
+            break;
+        
+        default:
+            status = _ght_rehash(table, width);
+            break;
     }
     
-    free(table->buckets);
-    table->buckets = new->buckets;
-    table->width = new->width;
-    GHT_MUTEX_DESTROY(new);
-    free(new);
+    _ght_unlock_all(table);
     
-    GHT_MUTEX_UNLOCK(table);
-    return 0;
+    if (table->read_mostly)
+    {
+        // Give the old chains back right away instead of holding two copies until the next batch.
+        _ght_ebr_drain();
+    }
+    
+    return status;
 }
 
-static ght_hash_t _ght_digestor_murmur3(ght_key_t key)
+GHT_API ght_hash_t ght_hash(ght_table_t* table, ght_key_t key)
 {
-    uint32_t seed = 0x9747b28c;
-    return GHT_DIGESTOR_MURMUR3(key, seed);
+    if (!table || table->key_mode == GHT_KEY_BYTES) return 0;
+    
+    return _ght_digest(table, key);
 }
 
-static GHT_FORCE_INLINE uint32_t _ght_digestor_murmur3_32(ght_key_t key, uint32_t seed)
+GHT_API ght_hash_t ght_digestor_mum(ght_key_t key, uint64_t seed)
 {
-    uint32_t hash = seed;
-    const uint32_t c1 = 0xcc9e2d51;
-    const uint32_t c2 = 0x1b873593;
+#if GHT_HASH_BITS == 64
+    // wyhash64: the key masked with both halves of the seed, multiplied to 128 bits and folded, twice.
+    uint64_t a = (uint64_t) key ^ seed ^ 0x2d358dccaa6c78a5ULL;
+    uint64_t b = (uint64_t) key ^ ((seed << 32) | (seed >> 32)) ^ 0x8bb84b93962eacc9ULL;
+    unsigned __int128 product = (unsigned __int128) a * b;
     
-    uint32_t k1 = key;
+    a = (uint64_t) product ^ 0x2d358dccaa6c78a5ULL;
+    b = (uint64_t) (product >> 64) ^ 0x8bb84b93962eacc9ULL;
+    product = (unsigned __int128) a * b;
     
-    k1 *= c1;
-    k1 = (k1 << 15) | (k1 >> (32 - 15));  // ROTL32(k1, 15)
-    k1 *= c2;
-
-    hash ^= k1;
-    hash = (hash << 13) | (hash >> (32 - 13));  // ROTL32(hash, 13)
-    hash = hash * 5 + 0xe6546b64;
+    return (ght_hash_t) ((uint64_t) product ^ (uint64_t) (product >> 64));
+#else
+    return _ght_digestor_murmur3_32(key, (uint32_t) (seed ^ (seed >> 32)));
+#endif
+}
 
-    // Finalization
-    hash ^= sizeof(uint32_t);
+GHT_API ght_status_t ght_reserve(ght_table_t* table, ght_load_t count)
+{
+    if (!table) return -1;
+    
+    ght_width_t width = _ght_reserve_width(table, count);
+    
+    if (!width) return -1;
+    
+    // Only ever grows, a table that already fits count entries is left alone.
+    return width > ght_width(table) ? ght_resize(table, width) : 0;
+}
+
+GHT_API ght_lf_table_t* ght_lf_create(ght_cfg_t* cfg)
+{
+    if (cfg && (cfg->key_mode == GHT_KEY_BYTES || !_ght_allocator_valid(&cfg->allocator))) return NULL;
+    
+    ght_allocator_t allocator = cfg ? cfg->allocator : (ght_allocator_t) {0};
+    ght_lf_table_t* lf = _ght_calloc(&allocator, 1, sizeof(ght_lf_table_t));
+    
+    if (!lf) return NULL;
+    
+    lf->table.allocator = allocator;    
+    ght_width_t width = cfg && cfg->width ? cfg->width : GHT_DEFAULT_WIDTH;
+    
+    lf->table.digestor = cfg ? cfg->digestor : NULL;
+    lf->table.keyed_digestor = cfg && (cfg->keyed_digestor || cfg->digestor) ? cfg->keyed_digestor : _ght_builtin_digestor(cfg ? cfg->digest : GHT_DIGEST_AUTO);
+    lf->table.seed = cfg && cfg->seed ? cfg->seed : _ght_random_seed();
+    lf->table.deallocator = cfg ? cfg->deallocator : NULL;
+    lf->table.auto_resize = cfg ? cfg->auto_resize : 0.0;
+    lf->table.key_mode = GHT_KEY_INTEGER;
+    lf->table.node_size = sizeof(ght_bucket_t);
+    lf->base = 1;
+    
+    while (lf->base < width && lf->base_bits < GHT_HASH_BITS - 2)
+    {
+        lf->base <<= 1;
+        lf->base_bits++;
+    }
+    
+    atomic_init(&lf->size, lf->base);
+    atomic_init(&lf->load, 0);
+    
+    // Bucket 0 heads the whole list, its sentinel sorts before every other node.
+    lf->segments[0] = _ght_calloc(&allocator, lf->base, sizeof(ght_bucket_t*));
+    
+    if (!lf->segments[0] || !(lf->segments[0][0] = _ght_bucket_alloc(&lf->table)))
+    {
+        ght_lf_destroy(lf);
+        return NULL;
+    }
+    
+    return lf;
+}
+
+GHT_API ght_status_t ght_lf_destroy(ght_lf_table_t* table)
+{
+    if (!table) return -1;
+    
+    _ght_ebr_flush(&table->table);
+    
+    ght_bucket_t* bucket = table->segments[0] ? table->segments[0][0] : NULL;
+    
+    while (bucket)
+    {
+        ght_bucket_t* next = GHT_LF_NEXT(bucket->next);
+        
+        // Sentinels have an even order, nodes marked but not yet unlinked still own their data.
+        if ((bucket->hash & 1) && table->table.deallocator)
+        {
+            table->table.deallocator(bucket->key, bucket->data);
+        }
+        
+        _ght_bucket_free(&table->table, bucket);
+        bucket = next;
+    }
+    
+    ght_allocator_t allocator = table->table.allocator;
+    
+    for (size_t i = 0; i < GHT_LF_SEGMENTS; i++)
+    {
+        _ght_free(&allocator, table->segments[i]);
+    }
+    
+    _ght_free(&allocator, table);
+    return 0;
+}
+
+GHT_API ght_status_t ght_lf_insert(ght_lf_table_t* table, ght_key_t key, ght_data_t data)
+{
+    if (!table) return -1;
+    
+    // The node doubles as the record of the replaced data when the key is already present.
+    ght_bucket_t* bucket = _ght_bucket_alloc(&table->table);
+    
+    if (!bucket) return -1;
+    
+    ght_hash_t hash = _ght_digest(&table->table, key);
+    
+    bucket->key = key;
+    bucket->hash = _ght_lf_reverse(hash) | 1;
+    bucket->data = data;
+    
+    ght_ebr_record_t* reader = _ght_ebr_enter();
+    
+    if (!reader)
+    {
+        _ght_bucket_free(&table->table, bucket);
+        return -1;
+    }
+    
+    ght_bucket_t* head = _ght_lf_head(table, hash, true);
+    ght_bucket_t** prev;
+    ght_bucket_t* curr;
+    
+    while (true)
+    {
+        if (_ght_lf_find(table, head, bucket->hash, key, &prev, &curr))
+        {
+            bucket->data = __atomic_exchange_n(&curr->data, data, __ATOMIC_ACQ_REL);
+            
+            // Readers may still hold the old data, it reaches the deallocator after a grace period.
+            if (table->table.deallocator)
+            {
+                _ght_ebr_retire(&table->table, _ght_reclaim_replaced, bucket, 0);
+            }
+            else
+            {
+                _ght_bucket_free(&table->table, bucket);
+            }
+            
+            break;
+        }
+        
+        bucket->next = curr;
+        
+        if (__atomic_compare_exchange_n(prev, &curr, bucket, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        {
+            ght_load_t load = atomic_fetch_add_explicit(&table->load, 1, memory_order_relaxed) + 1;
+            size_t size = atomic_load_explicit(&table->size, memory_order_relaxed);
+            
+            // Doubling only publishes the new bucket count, no entry moves.
+            if (table->table.auto_resize > 0.0 && size < ((size_t) 1 << (GHT_HASH_BITS - 2))
+                && (ght_load_factor_t) load > (ght_load_factor_t) size * table->table.auto_resize)
+            {
+                atomic_compare_exchange_strong_explicit(&table->size, &size, size * 2, memory_order_release, memory_order_relaxed);
+            }
+            
+            break;
+        }
+    }
+    
+    _ght_ebr_exit(reader);
+    _ght_ebr_collect();
+    return 0;
+}
+
+GHT_API ght_data_t ght_lf_search(ght_lf_table_t* table, ght_key_t key)
+{
+    if (!table) return 0;
+    
+    ght_hash_t hash = _ght_digest(&table->table, key);
+    ght_hash_t order = _ght_lf_reverse(hash) | 1;
+    ght_data_t data = 0;
+    
+    ght_ebr_record_t* reader = _ght_ebr_enter();
+    
+    if (!reader) return 0;
+    
+    ght_bucket_t* bucket = GHT_LF_NEXT(GHT_CONSUME(_ght_lf_head(table, hash, false)->next));
+    
+    // Searches never unlink, deleted nodes still point forward into the list and are stepped over.
+    while (bucket && (bucket->hash < order || (bucket->hash == order && bucket->key < key)))
+    {
+        bucket = GHT_LF_NEXT(GHT_CONSUME(bucket->next));
+    }
+    
+    if (bucket && bucket->hash == order && bucket->key == key && !GHT_LF_MARKED(GHT_CONSUME(bucket->next)))
+    {
+        data = __atomic_load_n(&bucket->data, __ATOMIC_ACQUIRE);
+    }
+    
+    _ght_ebr_exit(reader);
+    return data;
+}
+
+GHT_API ght_status_t ght_lf_delete(ght_lf_table_t* table, ght_key_t key)
+{
+    if (!table) return -1;
+    
+    ght_hash_t hash = _ght_digest(&table->table, key);
+    ght_hash_t order = _ght_lf_reverse(hash) | 1;
+    ght_status_t status = -1;
+    
+    ght_ebr_record_t* reader = _ght_ebr_enter();
+    
+    if (!reader) return -1;
+    
+    ght_bucket_t* head = _ght_lf_head(table, hash, true);
+    ght_bucket_t** prev;
+    ght_bucket_t* curr;
+    
+    while (_ght_lf_find(table, head, order, key, &prev, &curr))
+    {
+        ght_bucket_t* next = GHT_CONSUME(curr->next);
+        
+        // Marking the node is the deletion, unlinking it is only cleanup any later find can do.
+        if (GHT_LF_MARKED(next)
+            || !__atomic_compare_exchange_n(&curr->next, &next, (ght_bucket_t*) ((uintptr_t) next | GHT_LF_MARK),
+                                            false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            continue;
+        }
+        
+        atomic_fetch_sub_explicit(&table->load, 1, memory_order_relaxed);
+        status = 0;
+        
+        if (__atomic_compare_exchange_n(prev, &curr, next, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        {
+            _ght_ebr_retire(&table->table, _ght_reclaim_bucket, curr, 0);
+        }
+        else
+        {
+            _ght_lf_find(table, head, order, key, &prev, &curr);
+        }
+        
+        break;
+    }
+    
+    _ght_ebr_exit(reader);
+    _ght_ebr_collect();
+    return status;
+}
+
+GHT_API ght_load_t ght_lf_load(ght_lf_table_t* table)
+{
+    if (!table) return 0;
+    
+    return atomic_load_explicit(&table->load, memory_order_relaxed);
+}
+
+GHT_API ght_width_t ght_lf_width(ght_lf_table_t* table)
+{
+    if (!table) return 0;
+    
+    return atomic_load_explicit(&table->size, memory_order_relaxed);
+}
+
+GHT_API ght_load_factor_t ght_lf_load_factor(ght_lf_table_t* table)
+{
+    if (!table) return 0.0;
+    
+    return (ght_load_factor_t) ght_lf_load(table) / (ght_load_factor_t) ght_lf_width(table);
+}
+
+GHT_API ght_status_t ght_lf_resize(ght_lf_table_t* table, ght_width_t width)
+{
+    if (!table || !width || width > ((size_t) 1 << (GHT_HASH_BITS - 2))) return -1;
+    
+    size_t size = atomic_load_explicit(&table->size, memory_order_relaxed);
+    
+    // Buckets can only split, a smaller count would strand the sentinels past it.
+    if (width < size) return -1;
+    
+    while (size < width)
+    {
+        if (atomic_compare_exchange_weak_explicit(&table->size, &size, size * 2, memory_order_release, memory_order_relaxed))
+        {
+            size *= 2;
+        }
+    }
+    
+    return 0;
+}
+
+GHT_API ght_sharded_t* ght_sharded_create(ght_cfg_t* cfg, size_t shards)
+{
+    if (!shards || (cfg && (cfg->key_mode == GHT_KEY_BYTES || !_ght_allocator_valid(&cfg->allocator)))) return NULL;
+    
+    // A zeroed configuration selects the same defaults as none.
+    ght_cfg_t shard_cfg = cfg ? *cfg : (ght_cfg_t) {0};
+    ght_sharded_t* sharded = _ght_calloc(&shard_cfg.allocator, 1, sizeof(ght_sharded_t));
+    
+    if (!sharded) return NULL;
+    
+    sharded->allocator = shard_cfg.allocator;
+    ght_width_t width = shard_cfg.width ? shard_cfg.width : GHT_DEFAULT_WIDTH;
+    
+    sharded->count = 1;
+    
+    while (sharded->count < shards && sharded->bits < GHT_HASH_BITS - 1)
+    {
+        sharded->count <<= 1;
+        sharded->bits++;
+    }
+    
+    // Every shard hashes like the first one, so they share a seed and never re-seed on their own.
+    shard_cfg.seed = shard_cfg.seed ? shard_cfg.seed : _ght_random_seed();
+    shard_cfg.reseed_chain = 0;
+    shard_cfg.width = (width + sharded->count - 1) / sharded->count;
+    sharded->shards = _ght_calloc(&shard_cfg.allocator, sharded->count, sizeof(ght_table_t*));
+    
+    if (!sharded->shards)
+    {
+        _ght_free(&shard_cfg.allocator, sharded);
+        return NULL;
+    }
+    
+    for (size_t i = 0; i < sharded->count; i++)
+    {
+        if (!(sharded->shards[i] = ght_create(&shard_cfg)))
+        {
+            ght_sharded_destroy(sharded);
+            return NULL;
+        }
+    }
+    
+    return sharded;
+}
+
+GHT_API ght_status_t ght_sharded_destroy(ght_sharded_t* table)
+{
+    if (!table) return -1;
+    
+    for (size_t i = 0; i < table->count; i++)
+    {
+        ght_destroy(table->shards[i]);
+    }
+    
+    ght_allocator_t allocator = table->allocator;
+    
+    _ght_free(&allocator, table->shards);
+    _ght_free(&allocator, table);
+    return 0;
+}
+
+GHT_API ght_status_t ght_sharded_insert(ght_sharded_t* table, ght_key_t key, ght_data_t data)
+{
+    if (!table) return -1;
+    
+    ght_hash_t hash = _ght_digest(table->shards[0], key);
+    ght_table_t* shard = _ght_shard(table, hash);
+    
+    return ght_insert_hashed(shard, hash, key, data);
+}
+
+GHT_API ght_data_t ght_sharded_search(ght_sharded_t* table, ght_key_t key)
+{
+    if (!table) return 0;
+    
+    ght_hash_t hash = _ght_digest(table->shards[0], key);
+    ght_table_t* shard = _ght_shard(table, hash);
+    
+    return ght_search_hashed(shard, hash, key);
+}
+
+GHT_API ght_status_t ght_sharded_delete(ght_sharded_t* table, ght_key_t key)
+{
+    if (!table) return -1;
+    
+    ght_hash_t hash = _ght_digest(table->shards[0], key);
+    ght_table_t* shard = _ght_shard(table, hash);
+    
+    return ght_delete_hashed(shard, hash, key);
+}
+
+GHT_API ght_load_t ght_sharded_load(ght_sharded_t* table)
+{
+    if (!table) return 0;
+    
+    ght_load_t load = 0;
+    
+    for (size_t i = 0; i < table->count; i++)
+    {
+        load += ght_load(table->shards[i]);
+    }
+    
+    return load;
+}
+
+GHT_API ght_width_t ght_sharded_width(ght_sharded_t* table)
+{
+    if (!table) return 0;
+    
+    ght_width_t width = 0;
+    
+    for (size_t i = 0; i < table->count; i++)
+    {
+        width += ght_width(table->shards[i]);
+    }
+    
+    return width;
+}
+
+GHT_API ght_load_factor_t ght_sharded_load_factor(ght_sharded_t* table)
+{
+    if (!table) return 0.0;
+    
+    return (ght_load_factor_t) ght_sharded_load(table) / (ght_load_factor_t) ght_sharded_width(table);
+}
+
+GHT_API ght_status_t ght_sharded_resize(ght_sharded_t* table, ght_width_t width)
+{
+    if (!table || !width) return -1;
+    
+    ght_status_t status = 0;
+    
+    // Only the shard being resized is locked, the others keep serving operations.
+    for (size_t i = 0; i < table->count; i++)
+    {
+        status |= ght_resize(table->shards[i], (width + table->count - 1) / table->count);
+    }
+    
+    return status ? -1 : 0;
+}
+
+GHT_API ght_status_t ght_thread_register(void)
+{
+    return _ght_ebr_register() ? 0 : -1;
+}
+
+GHT_API void ght_thread_unregister(void)
+{
+    ght_ebr_record_t* record = _ght_ebr_self;
+    
+    if (!record || record->depth) return;
+    
+    if (_ght_ebr_key_ready)
+    {
+        tss_set(_ght_ebr_key, NULL);
+    }
+    
+    _ght_ebr_release(record);
+}
+
+static ght_status_t _ght_rehash(ght_table_t* table, ght_width_t width)
+{
+    width = _ght_round_width(table, width);
+    
+    if (table->read_mostly) return _ght_rcu_rehash(table, width);
+    
+    if (table->resize_mode == GHT_RESIZE_INCREMENTAL)
+    {
+        // Only one migration runs at a time, finish the current one first.
+        while (table->old_buckets)
+        {
+            _ght_migrate(table, table->old_width);
+        }
+        
+        ght_bucket_t** buckets = _ght_calloc(&table->allocator, width, sizeof(ght_bucket_t*));
+        
+        if (!buckets) return -1;
+        
+        table->old_buckets = table->buckets;
+        table->old_width = table->width;
+        table->old_magic = table->magic;
+        table->migrated = 0;
+        table->buckets = buckets;
+        table->width = width;
+        table->magic = _ght_index_magic(table->index_policy, width);
+        
+        return 0;
+    }
+    
+    if (table->resize_mode == GHT_RESIZE_COOPERATIVE)
+    {
+        // Every lock is held, so whatever is left of the current transfer moves here.
+        _ght_transfer_all(table);
+        
+        ght_bucket_t** buckets = _ght_calloc(&table->allocator, width, sizeof(ght_bucket_t*));
+        
+        if (!buckets) return -1;
+        
+        // Helpers read old_width and old_buckets before they take a bucket lock and check them again under it.
+        atomic_store_explicit(&table->transfer, 0, memory_order_relaxed);
+        atomic_store_explicit(&table->transferred, 0, memory_order_relaxed);
+        table->old_magic = table->magic;
+        __atomic_store_n(&table->old_width, table->width, __ATOMIC_RELAXED);
+        __atomic_store_n(&table->old_buckets, table->buckets, __ATOMIC_RELEASE);
+        table->buckets = buckets;
+        __atomic_store_n(&table->width, width, __ATOMIC_RELAXED);
+        table->magic = _ght_index_magic(table->index_policy, width);
+        
+        return 0;
+    }
+    
+    ght_cfg_t cfg = {
+                        .digestor = table->digestor,
+                        .keyed_digestor = table->keyed_digestor,
+                        .seed = table->seed,
+                        .deallocator = table->deallocator,
+                        .width = width,
+                        .auto_resize = 0.0,
+                        .index_policy = table->index_policy,
+                        .allocator = table->allocator
+                    };
+
+    ght_table_t* new = ght_create(&cfg);
+    
+    if (!new || !new->buckets)
+    {
+        ght_destroy(new);
+        return -1;
+    }
+    
+    ght_load_t load = table->stripes ? _ght_load_sum(table) : table->load;
+    ght_load_t moved = 0;
+    for (ght_load_t i = 0; moved < load && i < table->width; i++)
+    {
+        _ght_move_recursive(table->buckets[i], &moved, new);
+    }
+    
+    _ght_free(&table->allocator, table->buckets);
+    table->buckets = new->buckets;
+    table->magic = new->magic;
+    __atomic_store_n(&table->width, new->width, __ATOMIC_RELAXED);
+    GHT_MUTEX_DESTROY(new);
+    _ght_free(&table->allocator, new);
+    
+    return 0;
+}
+
+static ght_status_t _ght_auto_resize(ght_table_t* table, ght_width_t width, ght_width_t new_width)
+{
+    _ght_lock_all(table);
+    
+    // Another thread may have resized the table while the caller waited for the stripes.
+    ght_status_t status = table->width == width ? _ght_rehash(table, new_width) : 0;
+    
+    _ght_unlock_all(table);
+    
+    if (table->read_mostly)
+    {
+        _ght_ebr_drain();
+    }
+    
+    if (table->resize_mode == GHT_RESIZE_COOPERATIVE)
+    {
+        // The thread that started the transfer keeps claiming strides until none are left.
+        _ght_transfer_help(table, SIZE_MAX);
+    }
+    
+    return status;
+}
+
+static ght_status_t _ght_reseed(ght_table_t* table, uint64_t seed)
+{
+    _ght_lock_all(table);
+    
+    // Another thread may have re-seeded the table while the caller waited for the stripes.
+    if (table->seed != seed)
+    {
+        _ght_unlock_all(table);
+        return 0;
+    }
+    
+    if (table->resize_mode == GHT_RESIZE_COOPERATIVE)
+    {
+        _ght_transfer_all(table);
+    }
+    
+    while (table->old_buckets)
+    {
+        _ght_migrate(table, table->old_width);
+    }
+    
+    ght_bucket_t** buckets = _ght_calloc(&table->allocator, table->width, sizeof(ght_bucket_t*));
+    
+    if (!buckets)
+    {
+        _ght_unlock_all(table);
+        return -1;
+    }
+    
+    __atomic_store_n(&table->seed, _ght_random_seed(), __ATOMIC_RELAXED);
+    
+    // Keys change stripes along with their hashes, so the stripe loads are counted again.
+    for (size_t i = 0; i < table->stripe_count; i++)
+    {
+        atomic_store_explicit(&table->stripes[i].load, 0, memory_order_relaxed);
+    }
+    
+    for (ght_index_t i = 0; i < table->width; i++)
+    {
+        ght_bucket_t* bucket = table->buckets[i];
+        
+        while (bucket)
+        {
+            ght_bucket_t* next = bucket->next;
+            size_t length = table->key_mode == GHT_KEY_BYTES ? ((ght_bytes_bucket_t*) bucket)->length : 0;
+            
+            bucket->hash = _ght_digest_key(table, _ght_bucket_key(table, bucket), length);
+            
+            ght_index_t index = _ght_index(table->index_policy, bucket->hash, table->width, table->magic);
+            
+            bucket->next = buckets[index];
+            buckets[index] = bucket;
+            
+            if (table->stripes)
+            {
+                _ght_load_add(table, bucket->hash, 1);
+            }
+            
+            bucket = next;
+        }
+    }
+    
+    _ght_free(&table->allocator, table->buckets);
+    table->buckets = buckets;
+    table->reseed_load = table->stripes ? _ght_load_sum(table) : table->load;
+    
+    _ght_unlock_all(table);
+    return 0;
+}
+
+static ght_width_t _ght_reserve_width(ght_table_t* table, ght_load_t count)
+{
+    // 0 when no width fits count entries, the engine margins below multiply it by up to 16.
+    if (count > SIZE_MAX / 16) return 0;
+    
+    // Any table holds no entries, without auto_resize the width below would be 0.
+    if (!count) return 1;
+    
+    ght_load_factor_t fit = table->auto_resize > 0.0 ? (ght_load_factor_t) count / table->auto_resize : 0.0;
+    
+    if (fit >= (ght_load_factor_t) (SIZE_MAX / 2)) return 0;
+    
+    ght_width_t width = table->auto_resize > 0.0 ? (ght_width_t) fit + 1 : count;
+    
+    // Striped tables and the cuckoo engine grow on the estimate of a single counter, so leave room for the busiest
+    // one. Keys fall into the counters like balls into bins, rarely 4 standard deviations above the mean.
+    size_t counters = table->engine == GHT_ENGINE_CUCKOO ? table->lock_count : table->stripe_count;
+    
+    if (counters > 1)
+    {
+        ght_load_factor_t mean = (ght_load_factor_t) count / (ght_load_factor_t) counters + 1.0;
+        ght_load_factor_t deviation = mean;
+        
+        // Newton steps towards the square root, the library doesn't link libm for one margin.
+        for (int i = 0; i < 64; i++)
+        {
+            deviation = (deviation + mean / deviation) / 2.0;
+        }
+        
+        width += (ght_width_t) ((ght_load_factor_t) width * (4.0 * deviation + 4.0) / mean);
+    }
+    
+    // The flat engines also grow on their own fill limits, which must not trigger either.
+    switch (table->engine)
+    {
+        case GHT_ENGINE_OPEN_ADDRESSING:
+            return width > count * 16 / 7 + 1 ? width : count * 16 / 7 + 1;
+        
+        case GHT_ENGINE_ROBIN_HOOD:
+        case GHT_ENGINE_CUCKOO:
+            return width > count * 10 / 9 + 1 ? width : count * 10 / 9 + 1;
+        
+        default:
+            return width;
+    }
+}
+
+static ght_status_t _ght_bulk_insert(ght_table_t* table, const ght_key_t* keys, const ght_data_t* data, size_t count)
+{
+    ght_hash_t hashes[GHT_BATCH];
+    
+    // The table is not shared yet, so no lock is taken and nodes are linked without publication.
+    for (size_t base = 0; base < count; base += GHT_BATCH)
+    {
+        size_t batch = count - base < GHT_BATCH ? count - base : GHT_BATCH;
+        
+        for (size_t i = 0; i < batch; i++)
+        {
+            hashes[i] = _ght_digest(table, keys[base + i]);
+        }
+        
+        for (size_t i = 0; i < batch; i++)
+        {
+            ght_bucket_t** head = _ght_chain(table, hashes[i]);
+            ght_bucket_t* bucket = *head;
+            
+            while (bucket && (keys[base + i] != bucket->key))
+            {
+                bucket = bucket->next;
+            }
+            
+            if (bucket)
+            {
+                if (table->deallocator)
+                {
+                    table->deallocator(bucket->key, bucket->data);
+                }
+                
+                bucket->data = data[base + i];
+                continue;
+            }
+            
+            bucket = _ght_bucket_alloc(table);
+            
+            if (!bucket) return -1;
+            
+            bucket->key = keys[base + i];
+            bucket->hash = hashes[i];
+            bucket->data = data[base + i];
+            bucket->next = *head;
+            *head = bucket;
+            
+            _ght_load_add(table, hashes[i], 1);
+        }
+    }
+    
+    return 0;
+}
+
+static GHT_FORCE_INLINE ght_hash_t _ght_mulhi(ght_hash_t a, ght_width_t b)
+{
+#if GHT_HASH_BITS == 64
+    return (ght_hash_t) (((unsigned __int128) a * b) >> 64);
+#else
+    return (ght_hash_t) (((uint64_t) a * b) >> 32);
+#endif
+}
+
+static GHT_FORCE_INLINE uint32_t _ght_fold32(ght_hash_t hash)
+{
+#if GHT_HASH_BITS == 64
+    return (uint32_t) (hash ^ (hash >> 32));
+#else
+    return (uint32_t) hash;
+#endif
+}
+
+static GHT_FORCE_INLINE ght_index_t _ght_index(ght_index_policy_t policy, ght_hash_t hash, ght_width_t width, uint64_t magic)
+{
+    switch (policy)
+    {
+        case GHT_INDEX_POW2:
+            // The multiply spreads every bit of the hash into the high bits, so weak digestors still index well.
+            return (hash * GHT_GOLDEN) >> magic;
+        
+        case GHT_INDEX_FASTRANGE:
+            return _ght_mulhi(hash * GHT_GOLDEN, width);
+        
+        case GHT_INDEX_RECIPROCAL:
+#if GHT_HASH_BITS == 64
+            // Lemire's fastmod: the low 64 bits of magic * a hold the fraction a / width.
+            if (magic)
+            {
+                return (ght_index_t) (((unsigned __int128) (magic * _ght_fold32(hash)) * width) >> 64);
+            }
+#endif
+            return _ght_fold32(hash) % width;
+        
+        default:
+            return hash % width;
+    }
+}
+
+static uint64_t _ght_index_magic(ght_index_policy_t policy, ght_width_t width)
+{
+    if (policy == GHT_INDEX_POW2)
+    {
+        uint64_t shift = GHT_HASH_BITS;
+        
+        for (ght_width_t w = width; w > 1; w >>= 1)
+        {
+            shift--;
+        }
+        
+        return shift;
+    }
+    
+    if (policy == GHT_INDEX_RECIPROCAL && width <= UINT32_MAX)
+    {
+        return UINT64_MAX / width + 1;
+    }
+    
+    return 0;
+}
+
+static GHT_FORCE_INLINE ght_width_t _ght_round_width(ght_table_t* table, ght_width_t width)
+{
+    if (table->index_policy == GHT_INDEX_POW2)
+    {
+        ght_width_t pow2 = 2;
+        
+        while (pow2 < width)
+        {
+            pow2 <<= 1;
+        }
+        
+        width = pow2;
+    }
+    
+    if (!table->stripes) return width;
+    
+    return (width + table->stripe_count - 1) & ~(ght_width_t) (table->stripe_count - 1);
+}
+
+static GHT_FORCE_INLINE ght_stripe_t* _ght_stripe(ght_table_t* table, ght_hash_t hash)
+{
+    // Widths stay multiples of the stripe count, so reducing the hash the same way the index
+    // policy does maps every key of a bucket to the same stripe.
+    switch (table->index_policy)
+    {
+        case GHT_INDEX_POW2:
+        case GHT_INDEX_FASTRANGE:
+            return &table->stripes[_ght_mulhi(hash * GHT_GOLDEN, table->stripe_count)];
+        
+        case GHT_INDEX_RECIPROCAL:
+            return &table->stripes[_ght_fold32(hash) & (table->stripe_count - 1)];
+        
+        default:
+            return &table->stripes[hash & (table->stripe_count - 1)];
+    }
+}
+
+static GHT_FORCE_INLINE mtx_t* _ght_lock(ght_table_t* table, ght_hash_t hash)
+{
+    mtx_t* mutex = table->stripes ? &_ght_stripe(table, hash)->mutex : &table->mutex;
+    
+    mtx_lock(mutex);
+    return mutex;
+}
+
+static GHT_FORCE_INLINE mtx_t* _ght_lock_key(ght_table_t* table, ght_hash_t* hash, uint64_t* seed, ght_key_t key, size_t length)
+{
+    mtx_t* mutex = _ght_lock(table, *hash);
+    
+    // A re-seed holds every stripe, so once one is held the seed is stable. Rehash only when it moved since hashing.
+    while (table->reseed_chain && *seed != __atomic_load_n(&table->seed, __ATOMIC_RELAXED))
+    {
+        ght_hash_t current;
+        
+        *seed = __atomic_load_n(&table->seed, __ATOMIC_RELAXED);
+        current = _ght_digest_seeded(table, key, length, *seed);
+        
+        if (current == *hash) continue;
+        
+        mtx_unlock(mutex);
+        *hash = current;
+        mutex = _ght_lock(table, current);
+    }
+    
+    return mutex;
+}
+
+static GHT_FORCE_INLINE mtx_t* _ght_bucket_lock(ght_table_t* table, ght_index_t index, ght_width_t width)
+{
+    if (!table->stripes) return &table->mutex;
+    
+    // The stripe _ght_stripe gives every key of bucket index in an array of this width.
+    switch (table->index_policy)
+    {
+        case GHT_INDEX_POW2:
+        case GHT_INDEX_FASTRANGE:
+            return &table->stripes[index / (width / table->stripe_count)].mutex;
+        
+        default:
+            return &table->stripes[index & (table->stripe_count - 1)].mutex;
+    }
+}
+
+static void _ght_lock_all(ght_table_t* table)
+{
+    if (!table->stripes)
+    {
+        GHT_MUTEX_LOCK(table);
+        return;
+    }
+    
+    // Always in index order, so concurrent resizes can't deadlock.
+    for (size_t i = 0; i < table->stripe_count; i++)
+    {
+        mtx_lock(&table->stripes[i].mutex);
+    }
+}
+
+static void _ght_unlock_all(ght_table_t* table)
+{
+    if (!table->stripes)
+    {
+        GHT_MUTEX_UNLOCK(table);
+        return;
+    }
+    
+    for (size_t i = table->stripe_count; i > 0; i--)
+    {
+        mtx_unlock(&table->stripes[i - 1].mutex);
+    }
+}
+
+static GHT_FORCE_INLINE void _ght_load_add(ght_table_t* table, ght_hash_t hash, ptrdiff_t delta)
+{
+    if (!table->stripes)
+    {
+        table->load += delta;
+        return;
+    }
+    
+    // The stripe lock is held, the atomic only lets ght_load read the counter without it.
+    ght_stripe_t* stripe = _ght_stripe(table, hash);
+    atomic_store_explicit(&stripe->load, atomic_load_explicit(&stripe->load, memory_order_relaxed) + delta, memory_order_relaxed);
+}
+
+static ght_load_t _ght_load_sum(ght_table_t* table)
+{
+    ght_load_t load = 0;
+    
+    for (size_t i = 0; i < table->lock_count; i++)
+    {
+        load += atomic_load_explicit(&table->locks[i].load, memory_order_relaxed);
+    }
+    
+    for (size_t i = 0; i < table->stripe_count; i++)
+    {
+        load += atomic_load_explicit(&table->stripes[i].load, memory_order_relaxed);
+    }
+    
+    return load;
+}
+
+static GHT_FORCE_INLINE ght_load_t _ght_load_estimate(ght_table_t* table, ght_hash_t hash)
+{
+    // A striped table extrapolates from the caller's stripe instead of summing every counter.
+    return table->stripes ? atomic_load_explicit(&_ght_stripe(table, hash)->load, memory_order_relaxed) * table->stripe_count
+                          : table->load;
+}
+
+static GHT_FORCE_INLINE bool _ght_should_grow(ght_table_t* table, ght_hash_t hash)
+{
+    if (table->auto_resize <= 0.0 || table->old_buckets) return false;
+    
+    return (ght_load_factor_t) (_ght_load_estimate(table, hash) + 1)/(ght_load_factor_t) table->width > table->auto_resize;
+}
+
+static GHT_FORCE_INLINE bool _ght_should_shrink(ght_table_t* table, ght_load_t load)
+{
+    if (table->auto_shrink <= 0.0 || table->old_buckets || table->width / 2 < table->min_width) return false;
+    
+    return (ght_load_factor_t) load/(ght_load_factor_t) table->width < table->auto_shrink;
+}
+
+static ght_status_t _ght_insert(ght_table_t* table, ght_hash_t hash, uint64_t seed, ght_key_t key, size_t length, ght_data_t data)
+{
+    if (table->resize_mode == GHT_RESIZE_COOPERATIVE && __atomic_load_n(&table->old_buckets, __ATOMIC_RELAXED))
+    {
+        _ght_transfer_help(table, 1);
+    }
+    
+    mtx_t* mutex = _ght_lock_key(table, &hash, &seed, key, length);
+    
+    if (table->old_buckets && table->resize_mode == GHT_RESIZE_INCREMENTAL)
+    {
+        _ght_migrate(table, GHT_MIGRATE_BUCKETS);
+    }
+
+    ght_bucket_t** head = _ght_chain(table, hash);
+    ght_bucket_t* bucket = *head;
+    ght_bucket_t* prev = NULL;
+    size_t chain = 0;
+    
+    while (bucket && !_ght_match(table, bucket, hash, key, length))
+    {
+        prev = bucket;
+        bucket = bucket->next;
+        chain++;
+    }
+
+    if (bucket && table->read_mostly)
+    {
+        // Readers may be holding the node, replace it with an updated copy instead of writing to it.
+        ght_bucket_t* copy = _ght_bucket_alloc(table);
+        
+        if (!copy)
+        {
+            mtx_unlock(mutex);
+            return -1;
+        }
+        
+        memcpy(copy, bucket, table->node_size);
+        copy->data = data;
+        
+        if (prev)
+        {
+            GHT_PUBLISH(prev->next, copy);
+        }
+        else
+        {
+            GHT_PUBLISH(*head, copy);
+        }
+        
+        _ght_ebr_retire(table, _ght_reclaim_replaced, bucket, 0);
+        
+        mtx_unlock(mutex);
+        _ght_ebr_collect();
+        return 0;
+    }
+
+    if (bucket)
+    {
+        if (table->deallocator)
+        {
+            table->deallocator(_ght_bucket_key(table, bucket), bucket->data);
+        }
+
+        bucket->data = data;
+        
+        if (prev)
+        {
+            prev->next = bucket->next;
+            bucket->next = *head;
+            *head = bucket;
+        }
+        
+        mtx_unlock(mutex);
+        return 0;
+    }
+    
+    ght_load_t load = _ght_load_estimate(table, hash);
+    
+    // A chain this far above the average means colliding keys, scatter them with a new seed, at most once per doubling.
+    // The colliding keys crowd a stripe, so its estimate is confirmed against the exact load.
+    if (table->reseed_chain && chain > table->reseed_chain * (load / table->width + 1) && load >= table->reseed_load * 2
+        && (!table->stripes || _ght_load_sum(table) >= table->reseed_load * 2))
+    {
+        mtx_unlock(mutex);
+        
+        if (!_ght_reseed(table, seed))
+        {
+            seed = _ght_seed(table);
+            return _ght_insert(table, _ght_digest_seeded(table, key, length, seed), seed, key, length, data);
+        }
+        
+        mutex = _ght_lock_key(table, &hash, &seed, key, length);
+        head = _ght_chain(table, hash);
+    }
+    
+    if (_ght_should_grow(table, hash))
+    {
+        // Growing takes every stripe, so let go of ours and look the key up again afterwards.
+        ght_width_t width = table->width;
+        mtx_unlock(mutex);
+        
+        if (!_ght_auto_resize(table, width, width * 2))
+        {
+            return _ght_insert(table, hash, seed, key, length, data);
+        }
+        
+        mutex = _ght_lock_key(table, &hash, &seed, key, length);
+        head = _ght_chain(table, hash);
+    }
+
+    bucket = _ght_bucket_alloc(table);
+
+    if (!bucket || _ght_bucket_set_key(table, bucket, key, length))
+    {
+        if (bucket)
+        {
+            _ght_bucket_free(table, bucket);
+        }
+        
+        mtx_unlock(mutex);
+        return -1;
+    }
+    
+    bucket->data = data;
+    
+    bucket->hash = hash;
+    bucket->next = *head;
+    GHT_PUBLISH(*head, bucket);
+    _ght_load_add(table, hash, 1);
+    
+    mtx_unlock(mutex);
+    return 0;
+}
+
+static ght_data_t _ght_search(ght_table_t* table, ght_hash_t hash, uint64_t seed, ght_key_t key, size_t length)
+{
+    if (table->read_mostly) return _ght_rcu_search(table, hash, key, length);
+    
+    if (table->resize_mode == GHT_RESIZE_COOPERATIVE && __atomic_load_n(&table->old_buckets, __ATOMIC_RELAXED))
+    {
+        _ght_transfer_help(table, 1);
+    }
+    
+    mtx_t* mutex = _ght_lock_key(table, &hash, &seed, key, length);
+    
+    if (table->old_buckets && table->resize_mode == GHT_RESIZE_INCREMENTAL)
+    {
+        _ght_migrate(table, GHT_MIGRATE_BUCKETS);
+    }
+    
+    ght_bucket_t** head = _ght_chain(table, hash);
+    ght_bucket_t* bucket = *head;
+    ght_bucket_t* prev = NULL;
+    
+    while (bucket && !_ght_match(table, bucket, hash, key, length))
+    {
+        prev = bucket;
+        bucket = bucket->next;
+    }
+    
+    if (!bucket)
+    {
+        mtx_unlock(mutex);
+        return 0;
+    }
+
+    if (prev)
+    {
+        prev->next = bucket->next;
+        bucket->next = *head;
+        *head = bucket;
+    }
+    
+    ght_data_t data = bucket->data;
+
+    mtx_unlock(mutex);
+    return data;
+}
+
+static ght_status_t _ght_delete(ght_table_t* table, ght_hash_t hash, uint64_t seed, ght_key_t key, size_t length)
+{
+    if (table->resize_mode == GHT_RESIZE_COOPERATIVE && __atomic_load_n(&table->old_buckets, __ATOMIC_RELAXED))
+    {
+        _ght_transfer_help(table, 1);
+    }
+    
+    mtx_t* mutex = _ght_lock_key(table, &hash, &seed, key, length);
+    
+    if (table->old_buckets && table->resize_mode == GHT_RESIZE_INCREMENTAL)
+    {
+        _ght_migrate(table, GHT_MIGRATE_BUCKETS);
+    }
+    
+    ght_bucket_t** head = _ght_chain(table, hash);
+    ght_bucket_t* bucket = *head;
+    ght_bucket_t* prev = NULL;
+    
+    while (bucket && !_ght_match(table, bucket, hash, key, length))
+    {
+        prev = bucket;
+        bucket = bucket->next;
+    }
+    
+    if (!bucket)
+    {
+        mtx_unlock(mutex);
+        return -1;
+    }
+
+    if (prev)
+    {
+        GHT_PUBLISH(prev->next, bucket->next);
+    }
+    else
+    {
+        GHT_PUBLISH(*head, bucket->next);
+    }
+    
+    _ght_load_add(table, hash, -1);
+    
+    // Shrinking takes every stripe like growing does, so it also waits until ours is released.
+    ght_width_t width = table->width;
+    bool shrink = _ght_should_shrink(table, _ght_load_estimate(table, hash));
+    
+    if (table->read_mostly)
+    {
+        _ght_ebr_retire(table, _ght_reclaim_bucket, bucket, 0);
+        
+        mtx_unlock(mutex);
+        _ght_ebr_collect();
+    }
+    else
+    {
+        if (table->deallocator)
+        {
+            table->deallocator(_ght_bucket_key(table, bucket), bucket->data);
+        }
+        
+        _ght_bucket_release(table, bucket);
+        
+        mtx_unlock(mutex);
+    }
+    
+    if (shrink)
+    {
+        // A failed shrink leaves the table as it was, the key is gone either way.
+        _ght_auto_resize(table, width, width / 2);
+    }
+    
+    return 0;
+}
+
+static ght_hash_t _ght_digestor_murmur3(ght_key_t key, uint64_t seed)
+{
+    return GHT_DIGESTOR_MURMUR3(key, seed);
+}
+
+static ght_hash_t _ght_digestor_murmur3_bytes(const void* key, size_t length, uint64_t seed)
+{
+    // MurmurHash64A
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const uint8_t* bytes = key;
+    uint64_t hash = seed ^ (length * m);
+    
+    for (; length >= sizeof(uint64_t); bytes += sizeof(uint64_t), length -= sizeof(uint64_t))
+    {
+        uint64_t k;
+        memcpy(&k, bytes, sizeof(uint64_t));
+        
+        k *= m;
+        k ^= k >> 47;
+        k *= m;
+        
+        hash ^= k;
+        hash *= m;
+    }
+    
+    if (length)
+    {
+        uint64_t tail = 0;
+        
+        for (size_t i = 0; i < length; i++)
+        {
+            tail |= (uint64_t) bytes[i] << (8 * i);
+        }
+        
+        hash ^= tail;
+        hash *= m;
+    }
+    
+    hash ^= hash >> 47;
+    hash *= m;
+    hash ^= hash >> 47;
+    
+    return (ght_hash_t) hash;
+}
+
+static bool _ght_comparator_memcmp(const void* a, const void* b, size_t length)
+{
+    return !memcmp(a, b, length);
+}
+
+static uint64_t _ght_random_seed(void)
+{
+    uint64_t seed = 0;
+    
+#if defined(__linux__)
+    if (getrandom(&seed, sizeof(seed), 0) == sizeof(seed) && seed) return seed;
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+    arc4random_buf(&seed, sizeof(seed));
+    if (seed) return seed;
+#endif
+    
+    // No entropy source, at least keep tables and processes apart.
+    static atomic_size_t counter;
+    
+    seed = _ght_digestor_murmur3_64((uint64_t) (uintptr_t) &seed ^ (uint64_t) time(NULL), atomic_fetch_add(&counter, 1) + GHT_GOLDEN);
+    
+    // Zero marks a hash of unknown seed, never hand it out.
+    return seed ? seed : GHT_GOLDEN;
+}
+
+static ght_keyed_digestor_t _ght_builtin_digestor(ght_digest_t digest)
+{
+#ifdef GHT_HAVE_X86_DIGESTORS
+    __builtin_cpu_init();
+    
+    if ((digest == GHT_DIGEST_AUTO || digest == GHT_DIGEST_AES) && __builtin_cpu_supports("aes")) return _ght_digestor_aes;
+    if (digest == GHT_DIGEST_CRC32C && __builtin_cpu_supports("sse4.2")) return _ght_digestor_crc32c;
+#else
+    (void) digest;
+#endif
+    
+    return _ght_digestor_murmur3;
+}
+
+#ifdef GHT_HAVE_X86_DIGESTORS
+__attribute__((target("aes,sse2")))
+static ght_hash_t _ght_digestor_aes(ght_key_t key, uint64_t seed)
+{
+    // Two rounds are enough for every output byte to depend on every byte of the key and the seed.
+    __m128i round_key = _mm_set_epi64x((long long) (seed ^ 0x243f6a8885a308d3ULL), (long long) seed);
+    __m128i state = _mm_xor_si128(_mm_set1_epi64x((long long) key), round_key);
+    
+    state = _mm_aesenc_si128(state, round_key);
+    state = _mm_aesenc_si128(state, _mm_set_epi64x((long long) 0x13198a2e03707344ULL, (long long) 0xa4093822299f31d0ULL));
+    
+    return (ght_hash_t) (_mm_cvtsi128_si64(state) ^ _mm_cvtsi128_si64(_mm_unpackhi_epi64(state, state)));
+}
+
+__attribute__((target("sse4.2")))
+static ght_hash_t _ght_digestor_crc32c(ght_key_t key, uint64_t seed)
+{
+    // The rotated key keeps the high half from being a fixed function of the low half.
+    uint64_t low = _mm_crc32_u64(seed & 0xffffffff, key);
+    uint64_t high = _mm_crc32_u64(seed >> 32, (key << 32) | (key >> 32));
+    
+    return (ght_hash_t) ((high << 32) | low);
+}
+#endif
+
+static GHT_FORCE_INLINE ght_hash_t _ght_digest(ght_table_t* table, ght_key_t key)
+{
+    if (table->keyed_digestor) return table->keyed_digestor(key, _ght_seed(table));
+    
+    return table->digestor(key);
+}
+
+static GHT_FORCE_INLINE ght_hash_t _ght_digest_bytes(ght_table_t* table, const void* key, size_t length)
+{
+    if (table->bytes_digestor) return table->bytes_digestor(key, length);
+    
+    return _ght_digestor_murmur3_bytes(key, length, _ght_seed(table));
+}
+
+static GHT_FORCE_INLINE ght_hash_t _ght_digest_key(ght_table_t* table, ght_key_t key, size_t length)
+{
+    return _ght_digest_seeded(table, key, length, _ght_seed(table));
+}
+
+static GHT_FORCE_INLINE ght_hash_t _ght_digest_seeded(ght_table_t* table, ght_key_t key, size_t length, uint64_t seed)
+{
+    if (table->key_mode == GHT_KEY_BYTES)
+    {
+        if (table->bytes_digestor) return table->bytes_digestor((const void*) key, length);
+        return _ght_digestor_murmur3_bytes((const void*) key, length, seed);
+    }
+    
+    if (table->keyed_digestor) return table->keyed_digestor(key, seed);
+    
+    return table->digestor(key);
+}
+
+static GHT_FORCE_INLINE uint64_t _ght_seed(ght_table_t* table)
+{
+    // The seed only changes with every lock held, the atomic read lets keys be hashed before taking one.
+    return __atomic_load_n(&table->seed, __ATOMIC_RELAXED);
+}
+
+static GHT_FORCE_INLINE uint32_t _ght_digestor_murmur3_32(ght_key_t key, uint32_t seed)
+{
+    uint32_t hash = seed;
+    const uint32_t c1 = 0xcc9e2d51;
+    const uint32_t c2 = 0x1b873593;
+    
+    uint32_t k1 = key;
+    
+    k1 *= c1;
+    k1 = (k1 << 15) | (k1 >> (32 - 15));  // ROTL32(k1, 15)
+    k1 *= c2;
+
+    hash ^= k1;
+    hash = (hash << 13) | (hash >> (32 - 13));  // ROTL32(hash, 13)
+    hash = hash * 5 + 0xe6546b64;
+
+    // Finalization
+    hash ^= sizeof(uint32_t);
     hash ^= (hash >> 16);
     hash *= 0x85ebca6b;
     hash ^= (hash >> 13);
     hash *= 0xc2b2ae35;
     hash ^= (hash >> 16);
     
-    return hash;
+    return hash;
+}
+
+static GHT_FORCE_INLINE uint64_t _ght_digestor_murmur3_64(ght_key_t key, uint64_t seed)
+{
+    uint64_t hash = seed;
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+    
+    uint64_t k1 = key;
+    
+    k1 *= c1;
+    k1 = (k1 << 31) | (k1 >> (64 - 31));  // ROTL64(k1, 31)
+    k1 *= c2;
+
+    hash ^= k1;
+    hash = (hash << 27) | (hash >> (64 - 27));  // ROTL64(hash, 27)
+    hash = hash * 5 + 0x52dce729;
+
+    // Finalization
+    hash ^= sizeof(uint64_t);
+    hash ^= (hash >> 33);
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= (hash >> 33);
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= (hash >> 33);
+
+    return hash;
+}
+
+static void _ght_delete_recursive(ght_table_t* table, ght_bucket_t* bucket)
+{
+    if (!bucket) return;
+    
+    if (bucket->next)
+    {
+        _ght_delete_recursive(table, bucket->next);
+        bucket->next = NULL;
+    }
+    
+    if (table->deallocator)
+    {
+        table->deallocator(_ght_bucket_key(table, bucket), bucket->data);
+    }
+    
+    // Pooled nodes are released along with their slabs, only their out-of-line keys need freeing.
+    if (table->pool)
+    {
+        _ght_bucket_set_key(table, bucket, 0, 0);
+    }
+    else
+    {
+        _ght_bucket_release(table, bucket);
+    }
+    
+    table->load--;
+}
+
+static void _ght_move_recursive(ght_bucket_t* bucket, ght_load_t* moved, ght_table_t* to_table)
+{
+    if (!bucket) return;
+    
+    if (bucket->next)
+    {
+        _ght_move_recursive(bucket->next, moved, to_table);
+    }
+
+    ght_index_t index = _ght_index(to_table->index_policy, bucket->hash, to_table->width, to_table->magic);
+    bucket->next = to_table->buckets[index];
+    to_table->buckets[index] = bucket;
+    (*moved)++;
+}
+
+static GHT_FORCE_INLINE uint32_t _ght_oa_group_match(const int8_t* group, int8_t h2)
+{
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_load_si128((const __m128i*) group);
+    return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2)));
+#else
+    uint32_t match = 0;
+    for (ght_index_t i = 0; i < GHT_OA_GROUP_WIDTH; i++)
+    {
+        match |= (uint32_t) (group[i] == h2) << i;
+    }
+    return match;
+#endif
+}
+
+static GHT_FORCE_INLINE uint32_t _ght_oa_group_match_free(const int8_t* group)
+{
+#if defined(__SSE2__)
+    // EMPTY and DELETED are the only control bytes with the sign bit set.
+    return (uint32_t) _mm_movemask_epi8(_mm_load_si128((const __m128i*) group));
+#else
+    uint32_t match = 0;
+    for (ght_index_t i = 0; i < GHT_OA_GROUP_WIDTH; i++)
+    {
+        match |= (uint32_t) (group[i] < 0) << i;
+    }
+    return match;
+#endif
+}
+
+static GHT_FORCE_INLINE ght_width_t _ght_oa_capacity(ght_width_t width)
+{
+    ght_width_t capacity = GHT_OA_GROUP_WIDTH;
+    
+    while (capacity < width)
+    {
+        capacity <<= 1;
+    }
+    
+    return capacity;
+}
+
+static GHT_FORCE_INLINE ght_load_t _ght_oa_max_load(ght_width_t capacity)
+{
+    return capacity - capacity / 8;
+}
+
+static GHT_FORCE_INLINE ght_index_t _ght_oa_find(ght_table_t* table, ght_key_t key, ght_hash_t hash)
+{
+    ght_index_t mask = table->width / GHT_OA_GROUP_WIDTH - 1;
+    ght_index_t group = (hash >> 7) & mask;
+    int8_t h2 = hash & 0x7F;
+    
+    // Triangular probing over a power of two number of groups visits every group.
+    for (ght_index_t step = 1; ; step++)
+    {
+        const int8_t* ctrl = table->ctrl + group * GHT_OA_GROUP_WIDTH;
+        uint32_t match = _ght_oa_group_match(ctrl, h2);
+        
+        while (match)
+        {
+            ght_index_t index = group * GHT_OA_GROUP_WIDTH + __builtin_ctz(match);
+            
+            if (key == table->slots[index].key)
+            {
+                return index;
+            }
+            
+            match &= match - 1;
+        }
+        
+        if (_ght_oa_group_match(ctrl, GHT_OA_CTRL_EMPTY))
+        {
+            return GHT_OA_NOT_FOUND;
+        }
+        
+        group = (group + step) & mask;
+    }
+}
+
+static GHT_FORCE_INLINE ght_index_t _ght_oa_find_free(ght_table_t* table, ght_hash_t hash)
+{
+    ght_index_t mask = table->width / GHT_OA_GROUP_WIDTH - 1;
+    ght_index_t group = (hash >> 7) & mask;
+    
+    for (ght_index_t step = 1; ; step++)
+    {
+        uint32_t match = _ght_oa_group_match_free(table->ctrl + group * GHT_OA_GROUP_WIDTH);
+        
+        if (match)
+        {
+            return group * GHT_OA_GROUP_WIDTH + __builtin_ctz(match);
+        }
+        
+        group = (group + step) & mask;
+    }
+}
+
+static ght_status_t _ght_oa_alloc(ght_table_t* table, ght_width_t width)
+{
+    ght_width_t capacity = _ght_oa_capacity(width);
+    int8_t* ctrl = _ght_aligned_alloc(&table->allocator, GHT_OA_GROUP_WIDTH, capacity);
+    ght_slot_t* slots = _ght_malloc(&table->allocator, capacity * sizeof(ght_slot_t));
+    
+    if (!ctrl || !slots)
+    {
+        _ght_aligned_free(&table->allocator, ctrl);
+        _ght_free(&table->allocator, slots);
+        return -1;
+    }
+    
+    memset(ctrl, GHT_OA_CTRL_EMPTY, capacity);
+    
+    table->ctrl = ctrl;
+    table->slots = slots;
+    table->width = capacity;
+    table->tombstones = 0;
+    
+    return 0;
+}
+
+static ght_status_t _ght_oa_rehash(ght_table_t* table, ght_width_t width)
+{
+    if (table->load > _ght_oa_max_load(_ght_oa_capacity(width))) return -1;
+    
+    int8_t* old_ctrl = table->ctrl;
+    ght_slot_t* old_slots = table->slots;
+    ght_width_t old_width = table->width;
+    
+    if (_ght_oa_alloc(table, width)) return -1;
+    
+    for (ght_index_t i = 0; i < old_width; i++)
+    {
+        if (old_ctrl[i] < 0) continue;
+        
+        ght_hash_t hash = _ght_digest(table, old_slots[i].key);
+        ght_index_t index = _ght_oa_find_free(table, hash);
+        
+        table->ctrl[index] = hash & 0x7F;
+        table->slots[index] = old_slots[i];
+    }
+    
+    _ght_aligned_free(&table->allocator, old_ctrl);
+    _ght_free(&table->allocator, old_slots);
+    
+    return 0;
+}
+
+static void _ght_oa_destroy(ght_table_t* table)
+{
+    for (ght_index_t i = 0; table->deallocator && table->load && (i < table->width); i++)
+    {
+        if (table->ctrl[i] < 0) continue;
+        
+        table->deallocator(table->slots[i].key, table->slots[i].data);
+        table->load--;
+    }
+    
+    _ght_aligned_free(&table->allocator, table->ctrl);
+    _ght_free(&table->allocator, table->slots);
+    table->ctrl = NULL;
+    table->slots = NULL;
+}
+
+static ght_status_t _ght_oa_insert(ght_table_t* table, ght_hash_t hash, ght_key_t key, ght_data_t data)
+{
+    GHT_MUTEX_LOCK(table);
+    
+    ght_index_t index = _ght_oa_find(table, key, hash);
+    
+    if (index != GHT_OA_NOT_FOUND)
+    {
+        if (table->deallocator)
+        {
+            table->deallocator(table->slots[index].key, table->slots[index].data);
+        }
+        
+        table->slots[index].data = data;
+        
+        GHT_MUTEX_UNLOCK(table);
+        return 0;
+    }
+    
+    int grow = table->auto_resize > 0.0 && (ght_load_factor_t) (table->load + 1)/(ght_load_factor_t) table->width > table->auto_resize;
+    
+    if (grow || table->load + table->tombstones + 1 > _ght_oa_max_load(table->width))
+    {
+        // Double once live entries would fill half the usable slots, otherwise only purge the tombstones.
+        grow |= (table->load + 1) * 2 > _ght_oa_max_load(table->width);
+        
+        if (_ght_oa_rehash(table, grow ? table->width * 2 : table->width))
+        {
+            GHT_MUTEX_UNLOCK(table);
+            return -1;
+        }
+    }
+    
+    index = _ght_oa_find_free(table, hash);
+    
+    if (table->ctrl[index] == GHT_OA_CTRL_DELETED)
+    {
+        table->tombstones--;
+    }
+    
+    table->ctrl[index] = hash & 0x7F;
+    table->slots[index].key = key;
+    table->slots[index].data = data;
+    table->load++;
+    
+    GHT_MUTEX_UNLOCK(table);
+    return 0;
+}
+
+static ght_data_t _ght_oa_search(ght_table_t* table, ght_hash_t hash, ght_key_t key)
+{
+    GHT_MUTEX_LOCK(table);
+    
+    ght_index_t index = _ght_oa_find(table, key, hash);
+    ght_data_t data = index != GHT_OA_NOT_FOUND ? table->slots[index].data : 0;
+    
+    GHT_MUTEX_UNLOCK(table);
+    return data;
+}
+
+static size_t _ght_oa_search_batch(ght_table_t* table, const ght_key_t* keys, ght_data_t* data, bool* found, size_t count)
+{
+    size_t hits = 0;
+    GHT_MUTEX_LOCK(table);
+    
+    for (size_t base = 0; base < count; base += GHT_BATCH)
+    {
+        size_t batch = count - base < GHT_BATCH ? count - base : GHT_BATCH;
+        ght_index_t mask = table->width / GHT_OA_GROUP_WIDTH - 1;
+        ght_hash_t hashes[GHT_BATCH];
+        
+        // Fetch the first control group and its slots of every key before probing any of them.
+        for (size_t i = 0; i < batch; i++)
+        {
+            hashes[i] = _ght_digest(table, keys[base + i]);
+            
+            ght_index_t group = (hashes[i] >> 7) & mask;
+            __builtin_prefetch(table->ctrl + group * GHT_OA_GROUP_WIDTH);
+            __builtin_prefetch(table->slots + group * GHT_OA_GROUP_WIDTH);
+        }
+        
+        for (size_t i = 0; i < batch; i++)
+        {
+            ght_index_t index = _ght_oa_find(table, keys[base + i], hashes[i]);
+            
+            data[base + i] = index != GHT_OA_NOT_FOUND ? table->slots[index].data : 0;
+            
+            hits += index != GHT_OA_NOT_FOUND;
+            if (found) found[base + i] = index != GHT_OA_NOT_FOUND;
+        }
+    }
+    
+    GHT_MUTEX_UNLOCK(table);
+    return hits;
+}
+
+static ght_status_t _ght_oa_delete(ght_table_t* table, ght_hash_t hash, ght_key_t key)
+{
+    GHT_MUTEX_LOCK(table);
+    
+    ght_index_t index = _ght_oa_find(table, key, hash);
+    
+    if (index == GHT_OA_NOT_FOUND)
+    {
+        GHT_MUTEX_UNLOCK(table);
+        return -1;
+    }
+    
+    // No probe sequence ever continued past a group that still holds an EMPTY byte, so no tombstone is needed.
+    if (_ght_oa_group_match(table->ctrl + (index & ~(ght_index_t) (GHT_OA_GROUP_WIDTH - 1)), GHT_OA_CTRL_EMPTY))
+    {
+        table->ctrl[index] = GHT_OA_CTRL_EMPTY;
+    }
+    else
+    {
+        table->ctrl[index] = GHT_OA_CTRL_DELETED;
+        table->tombstones++;
+    }
+    
+    if (table->deallocator)
+    {
+        table->deallocator(table->slots[index].key, table->slots[index].data);
+    }
+    
+    table->load--;
+    
+    // Only if the next insert would not double the halved table straight back.
+    if (_ght_should_shrink(table, table->load) && (table->load + 1) * 2 <= _ght_oa_max_load(table->width / 2))
+    {
+        _ght_oa_rehash(table, table->width / 2);
+    }
+    
+    GHT_MUTEX_UNLOCK(table);
+    return 0;
+}
+
+static GHT_FORCE_INLINE ght_load_t _ght_rh_max_load(ght_width_t capacity)
+{
+    return capacity - capacity / 10;
+}
+
+static GHT_FORCE_INLINE ght_index_t _ght_rh_home(ght_table_t* table, ght_hash_t hash)
+{
+    return _ght_index(GHT_INDEX_POW2, hash, table->width, table->magic);
+}
+
+static GHT_FORCE_INLINE ght_index_t _ght_rh_find(ght_table_t* table, ght_key_t key, ght_hash_t hash)
+{
+    ght_index_t mask = table->width - 1;
+    ght_index_t index = _ght_rh_home(table, hash);
+    
+    // Slots stay ordered by home slot, so a slot closer to its own home than we are to ours ends the search.
+    for (unsigned distance = 1; distance <= table->distances[index]; distance++)
+    {
+        if (distance == table->distances[index] && key == table->slots[index].key)
+        {
+            return index;
+        }
+        
+        index = (index + 1) & mask;
+    }
+    
+    return GHT_OA_NOT_FOUND;
+}
+
+static ght_status_t _ght_rh_place(ght_table_t* table, ght_slot_t slot, ght_hash_t hash)
+{
+    ght_index_t mask = table->width - 1;
+    ght_index_t index = _ght_rh_home(table, hash);
+    unsigned distance = 1;
+    
+    // The new entry goes in front of the first richer slot, which shifts the run up to the next empty slot by one.
+    while (distance <= table->distances[index])
+    {
+        if (++distance > GHT_RH_MAX_DISTANCE) return -1;
+        index = (index + 1) & mask;
+    }
+    
+    ght_index_t end = index;
+    
+    while (table->distances[end])
+    {
+        if (table->distances[end] == GHT_RH_MAX_DISTANCE) return -1;
+        end = (end + 1) & mask;
+    }
+    
+    // Nothing was touched until the shift is known to fit, so a failed placement leaves the table intact.
+    for (; end != index; end = (end - 1) & mask)
+    {
+        ght_index_t prev = (end - 1) & mask;
+        
+        table->slots[end] = table->slots[prev];
+        table->distances[end] = table->distances[prev] + 1;
+    }
+    
+    table->slots[index] = slot;
+    table->distances[index] = (uint8_t) distance;
+    
+    return 0;
+}
+
+static ght_status_t _ght_rh_alloc(ght_table_t* table, ght_width_t width)
+{
+    ght_width_t capacity = _ght_oa_capacity(width);
+    uint8_t* distances = _ght_calloc(&table->allocator, capacity, sizeof(uint8_t));
+    ght_slot_t* slots = _ght_malloc(&table->allocator, capacity * sizeof(ght_slot_t));
+    
+    if (!distances || !slots)
+    {
+        _ght_free(&table->allocator, distances);
+        _ght_free(&table->allocator, slots);
+        return -1;
+    }
+    
+    table->distances = distances;
+    table->slots = slots;
+    table->width = capacity;
+    table->magic = _ght_index_magic(GHT_INDEX_POW2, capacity);
+    
+    return 0;
+}
+
+static ght_status_t _ght_rh_rehash(ght_table_t* table, ght_width_t width)
+{
+    if (table->load > _ght_rh_max_load(_ght_oa_capacity(width))) return -1;
+    
+    uint8_t* old_distances = table->distances;
+    ght_slot_t* old_slots = table->slots;
+    ght_width_t old_width = table->width;
+    uint64_t old_magic = table->magic;
+    
+    if (_ght_rh_alloc(table, width)) return -1;
+    
+    for (ght_index_t i = 0; i < old_width; i++)
+    {
+        if (!old_distances[i]) continue;
+        
+        // Only a digestor that collides far beyond chance can overflow the distances, keep the old arrays then.
+        if (_ght_rh_place(table, old_slots[i], _ght_digest(table, old_slots[i].key)))
+        {
+            _ght_free(&table->allocator, table->distances);
+            _ght_free(&table->allocator, table->slots);
+            table->distances = old_distances;
+            table->slots = old_slots;
+            table->width = old_width;
+            table->magic = old_magic;
+            return -1;
+        }
+    }
+    
+    _ght_free(&table->allocator, old_distances);
+    _ght_free(&table->allocator, old_slots);
+    
+    return 0;
+}
+
+static void _ght_rh_destroy(ght_table_t* table)
+{
+    for (ght_index_t i = 0; table->deallocator && table->load && (i < table->width); i++)
+    {
+        if (!table->distances[i]) continue;
+        
+        table->deallocator(table->slots[i].key, table->slots[i].data);
+        table->load--;
+    }
+    
+    _ght_free(&table->allocator, table->distances);
+    _ght_free(&table->allocator, table->slots);
+    table->distances = NULL;
+    table->slots = NULL;
+}
+
+static ght_status_t _ght_rh_insert(ght_table_t* table, ght_hash_t hash, ght_key_t key, ght_data_t data)
+{
+    GHT_MUTEX_LOCK(table);
+    
+    ght_index_t index = _ght_rh_find(table, key, hash);
+    
+    if (index != GHT_OA_NOT_FOUND)
+    {
+        if (table->deallocator)
+        {
+            table->deallocator(table->slots[index].key, table->slots[index].data);
+        }
+        
+        table->slots[index].data = data;
+        
+        GHT_MUTEX_UNLOCK(table);
+        return 0;
+    }
+    
+    int grow = table->auto_resize > 0.0 && (ght_load_factor_t) (table->load + 1)/(ght_load_factor_t) table->width > table->auto_resize;
+    ght_slot_t slot = {.key = key, .data = data};
+    
+    if ((grow || table->load + 1 > _ght_rh_max_load(table->width)) && _ght_rh_rehash(table, table->width * 2))
+    {
+        GHT_MUTEX_UNLOCK(table);
+        return -1;
+    }
+    
+    // A probe run too long for its distance byte is normally cured by spreading the keys over twice the slots.
+    if (_ght_rh_place(table, slot, hash) && (_ght_rh_rehash(table, table->width * 2) || _ght_rh_place(table, slot, hash)))
+    {
+        GHT_MUTEX_UNLOCK(table);
+        return -1;
+    }
+    
+    table->load++;
+    
+    GHT_MUTEX_UNLOCK(table);
+    return 0;
+}
+
+static ght_data_t _ght_rh_search(ght_table_t* table, ght_hash_t hash, ght_key_t key)
+{
+    GHT_MUTEX_LOCK(table);
+    
+    ght_index_t index = _ght_rh_find(table, key, hash);
+    ght_data_t data = index != GHT_OA_NOT_FOUND ? table->slots[index].data : 0;
+    
+    GHT_MUTEX_UNLOCK(table);
+    return data;
+}
+
+static size_t _ght_rh_search_batch(ght_table_t* table, const ght_key_t* keys, ght_data_t* data, bool* found, size_t count)
+{
+    size_t hits = 0;
+    GHT_MUTEX_LOCK(table);
+    
+    for (size_t base = 0; base < count; base += GHT_BATCH)
+    {
+        size_t batch = count - base < GHT_BATCH ? count - base : GHT_BATCH;
+        ght_hash_t hashes[GHT_BATCH];
+        
+        for (size_t i = 0; i < batch; i++)
+        {
+            hashes[i] = _ght_digest(table, keys[base + i]);
+            
+            ght_index_t home = _ght_rh_home(table, hashes[i]);
+            __builtin_prefetch(table->distances + home);
+            __builtin_prefetch(table->slots + home);
+        }
+        
+        for (size_t i = 0; i < batch; i++)
+        {
+            ght_index_t index = _ght_rh_find(table, keys[base + i], hashes[i]);
+            
+            data[base + i] = index != GHT_OA_NOT_FOUND ? table->slots[index].data : 0;
+            
+            hits += index != GHT_OA_NOT_FOUND;
+            if (found) found[base + i] = index != GHT_OA_NOT_FOUND;
+        }
+    }
+    
+    GHT_MUTEX_UNLOCK(table);
+    return hits;
+}
+
+static ght_status_t _ght_rh_delete(ght_table_t* table, ght_hash_t hash, ght_key_t key)
+{
+    GHT_MUTEX_LOCK(table);
+    
+    ght_index_t index = _ght_rh_find(table, key, hash);
+    
+    if (index == GHT_OA_NOT_FOUND)
+    {
+        GHT_MUTEX_UNLOCK(table);
+        return -1;
+    }
+    
+    if (table->deallocator)
+    {
+        table->deallocator(table->slots[index].key, table->slots[index].data);
+    }
+    
+    // Pull the following displaced slots one step closer to home until one already sits there or is empty.
+    ght_index_t mask = table->width - 1;
+    ght_index_t next = (index + 1) & mask;
+    
+    while (table->distances[next] > 1)
+    {
+        table->slots[index] = table->slots[next];
+        table->distances[index] = table->distances[next] - 1;
+        index = next;
+        next = (next + 1) & mask;
+    }
+    
+    table->distances[index] = 0;
+    table->load--;
+    
+    if (_ght_should_shrink(table, table->load) && table->load + 1 <= _ght_rh_max_load(table->width / 2))
+    {
+        _ght_rh_rehash(table, table->width / 2);
+    }
+    
+    GHT_MUTEX_UNLOCK(table);
+    return 0;
+}
+
+#define GHT_CUCKOO_DONE     (0)
+#define GHT_CUCKOO_RETRY    (1)                 // Lost a race with another writer or a resize.
+#define GHT_CUCKOO_GROW     (2)                 // The table is over its auto_resize load factor.
+#define GHT_CUCKOO_FULL     (3)                 // No displacement path frees a slot in either bucket.
+
+static GHT_FORCE_INLINE ght_hash_t _ght_cuckoo_mix(ght_hash_t hash)
+{
+    // Both the bucket (low bits) and the tag (top byte) depend on every bit, so weak digestors still spread.
+    hash = (hash ^ (hash >> (GHT_HASH_BITS / 2))) * GHT_GOLDEN;
+    return hash ^ (hash >> (GHT_HASH_BITS / 2));
+}
+
+static GHT_FORCE_INLINE uint8_t _ght_cuckoo_tag(ght_hash_t hash)
+{
+    uint8_t tag = (uint8_t) (hash >> (GHT_HASH_BITS - 8));
+    
+    return tag ? tag : 1;
+}
+
+static GHT_FORCE_INLINE ght_index_t _ght_cuckoo_alt(ght_index_t bucket, uint8_t tag, ght_index_t mask)
+{
+    // Derived from the tag alone so a displacement can find an entry's other bucket without rehashing its key.
+    return (bucket ^ ((ght_index_t) (tag + 1) * GHT_GOLDEN)) & mask;
+}
+
+static GHT_FORCE_INLINE uint8_t _ght_cuckoo_slot_tag(uint32_t tags, unsigned slot)
+{
+    return (uint8_t) (tags >> (8 * slot));
+}
+
+static GHT_FORCE_INLINE void _ght_cuckoo_set_tag(ght_cuckoo_t* cuckoo, ght_index_t bucket, unsigned slot, uint8_t tag)
+{
+    uint32_t tags = cuckoo->tags[bucket];
+    
+    tags &= ~((uint32_t) 0xFF << (8 * slot));
+    tags |= (uint32_t) tag << (8 * slot);
+    __atomic_store_n(&cuckoo->tags[bucket], tags, __ATOMIC_RELAXED);
+}
+
+static GHT_FORCE_INLINE int _ght_cuckoo_find(ght_cuckoo_t* cuckoo, ght_index_t bucket, ght_key_t key, uint8_t tag)
+{
+    uint32_t tags = __atomic_load_n(&cuckoo->tags[bucket], __ATOMIC_RELAXED);
+    
+    for (unsigned slot = 0; slot < GHT_CUCKOO_WAYS; slot++)
+    {
+        if (_ght_cuckoo_slot_tag(tags, slot) == tag && __atomic_load_n(&cuckoo->buckets[bucket].keys[slot], __ATOMIC_RELAXED) == key)
+        {
+            return (int) slot;
+        }
+    }
+    
+    return -1;
+}
+
+static GHT_FORCE_INLINE int _ght_cuckoo_free_slot(ght_cuckoo_t* cuckoo, ght_index_t bucket)
+{
+    uint32_t tags = __atomic_load_n(&cuckoo->tags[bucket], __ATOMIC_RELAXED);
+    
+    for (unsigned slot = 0; slot < GHT_CUCKOO_WAYS; slot++)
+    {
+        if (!_ght_cuckoo_slot_tag(tags, slot)) return (int) slot;
+    }
+    
+    return -1;
+}
+
+static GHT_FORCE_INLINE int _ght_cuckoo_find_pair(ght_cuckoo_t* cuckoo, ght_index_t first, ght_index_t second, ght_key_t key, uint8_t tag, ght_index_t* bucket)
+{
+    int slot = _ght_cuckoo_find(cuckoo, first, key, tag);
+    *bucket = first;
+    
+    if (slot < 0)
+    {
+        slot = _ght_cuckoo_find(cuckoo, second, key, tag);
+        *bucket = second;
+    }
+    
+    return slot;
+}
+
+static GHT_FORCE_INLINE int _ght_cuckoo_free_pair(ght_cuckoo_t* cuckoo, ght_index_t first, ght_index_t second, ght_index_t* bucket)
+{
+    int slot = _ght_cuckoo_free_slot(cuckoo, first);
+    *bucket = first;
+    
+    if (slot < 0)
+    {
+        slot = _ght_cuckoo_free_slot(cuckoo, second);
+        *bucket = second;
+    }
+    
+    return slot;
+}
+
+static GHT_FORCE_INLINE void _ght_cuckoo_store(ght_cuckoo_t* cuckoo, ght_index_t bucket, unsigned slot, ght_key_t key, ght_data_t data, uint8_t tag)
+{
+    __atomic_store_n(&cuckoo->buckets[bucket].keys[slot], key, __ATOMIC_RELAXED);
+    __atomic_store_n(&cuckoo->buckets[bucket].data[slot], data, __ATOMIC_RELAXED);
+    _ght_cuckoo_set_tag(cuckoo, bucket, slot, tag);
+}
+
+static GHT_FORCE_INLINE ght_cuckoo_lock_t* _ght_cuckoo_lock_of(ght_table_t* table, ght_index_t bucket)
+{
+    return &table->locks[bucket & (table->lock_count - 1)];
+}
+
+static GHT_FORCE_INLINE size_t _ght_cuckoo_locks_used(ght_table_t* table, ght_cuckoo_t* cuckoo)
+{
+    // Smaller tables only map their buckets onto the first locks.
+    return table->lock_count < cuckoo->mask + 1 ? table->lock_count : cuckoo->mask + 1;
+}
+
+static void _ght_cuckoo_lock(ght_cuckoo_lock_t* lock)
+{
+    size_t version = atomic_load_explicit(&lock->version, memory_order_relaxed);
+    
+    while ((version & 1) || !atomic_compare_exchange_weak_explicit(&lock->version, &version, version + 1,
+                                                                    memory_order_acquire, memory_order_relaxed))
+    {
+        thrd_yield();
+        version = atomic_load_explicit(&lock->version, memory_order_relaxed);
+    }
+    
+    // Orders the odd version before the slot stores, a reader that sees one of them fails its version check.
+    atomic_thread_fence(memory_order_release);
+}
+
+static GHT_FORCE_INLINE void _ght_cuckoo_unlock(ght_cuckoo_lock_t* lock)
+{
+    atomic_fetch_add_explicit(&lock->version, 1, memory_order_release);
+}
+
+static void _ght_cuckoo_lock_pair(ght_table_t* table, ght_index_t first, ght_index_t second)
+{
+    ght_cuckoo_lock_t* a = _ght_cuckoo_lock_of(table, first);
+    ght_cuckoo_lock_t* b = _ght_cuckoo_lock_of(table, second);
+    
+    // Lock order is array order, the same as _ght_cuckoo_lock_all.
+    if (a > b)
+    {
+        ght_cuckoo_lock_t* swap = a;
+        a = b;
+        b = swap;
+    }
+    
+    _ght_cuckoo_lock(a);
+    
+    if (b != a)
+    {
+        _ght_cuckoo_lock(b);
+    }
+}
+
+static void _ght_cuckoo_unlock_pair(ght_table_t* table, ght_index_t first, ght_index_t second)
+{
+    ght_cuckoo_lock_t* a = _ght_cuckoo_lock_of(table, first);
+    ght_cuckoo_lock_t* b = _ght_cuckoo_lock_of(table, second);
+    
+    _ght_cuckoo_unlock(a);
+    
+    if (b != a)
+    {
+        _ght_cuckoo_unlock(b);
+    }
+}
+
+static GHT_FORCE_INLINE size_t _ght_cuckoo_read_begin(ght_cuckoo_lock_t* lock)
+{
+    size_t version;
+    
+    while ((version = atomic_load_explicit(&lock->version, memory_order_acquire)) & 1)
+    {
+        thrd_yield();
+    }
+    
+    return version;
+}
+
+static ght_cuckoo_t* _ght_cuckoo_alloc(ght_table_t* table, ght_width_t width)
+{
+    ght_index_t count = 2;
+    
+    while (count * GHT_CUCKOO_WAYS < width)
+    {
+        count <<= 1;
+    }
+    
+    ght_cuckoo_t* cuckoo = _ght_malloc(&table->allocator, sizeof(ght_cuckoo_t));
+    ght_cuckoo_bucket_t* buckets = _ght_aligned_alloc(&table->allocator, GHT_CACHE_LINE, count * sizeof(ght_cuckoo_bucket_t));
+    uint32_t* tags = _ght_calloc(&table->allocator, count, sizeof(uint32_t));
+    
+    if (!cuckoo || !buckets || !tags)
+    {
+        _ght_free(&table->allocator, cuckoo);
+        _ght_aligned_free(&table->allocator, buckets);
+        _ght_free(&table->allocator, tags);
+        return NULL;
+    }
+    
+    cuckoo->buckets = buckets;
+    cuckoo->tags = tags;
+    cuckoo->mask = count - 1;
+    
+    return cuckoo;
+}
+
+static void _ght_cuckoo_free(ght_table_t* table, ght_cuckoo_t* cuckoo)
+{
+    if (!cuckoo) return;
+    
+    _ght_aligned_free(&table->allocator, cuckoo->buckets);
+    _ght_free(&table->allocator, cuckoo->tags);
+    _ght_free(&table->allocator, cuckoo);
+}
+
+static size_t _ght_cuckoo_search_path(ght_cuckoo_t* cuckoo, ght_index_t first, ght_index_t second, ght_cuckoo_step_t* path)
+{
+    ght_cuckoo_step_t queue[GHT_CUCKOO_QUEUE];
+    size_t tail = 0;
+    
+    queue[tail++] = (ght_cuckoo_step_t) {.bucket = first, .from = first, .parent = SIZE_MAX};
+    
+    if (second != first)
+    {
+        queue[tail++] = (ght_cuckoo_step_t) {.bucket = second, .from = second, .parent = SIZE_MAX};
+    }
+    
+    // Breadth-first over the buckets the current entries could move to, reading tags without locks.
+    for (size_t head = 0; head < tail; head++)
+    {
+        ght_cuckoo_step_t* step = &queue[head];
+        
+        if (_ght_cuckoo_free_slot(cuckoo, step->bucket) >= 0)
+        {
+            size_t length = 0;
+            
+            for (size_t i = head; i != SIZE_MAX; i = queue[i].parent)
+            {
+                path[length++] = queue[i];
+            }
+            
+            return length;
+        }
+        
+        if (step->depth == GHT_CUCKOO_DEPTH) continue;
+        
+        uint32_t tags = __atomic_load_n(&cuckoo->tags[step->bucket], __ATOMIC_RELAXED);
+        
+        for (unsigned slot = 0; slot < GHT_CUCKOO_WAYS && tail < GHT_CUCKOO_QUEUE; slot++)
+        {
+            uint8_t tag = _ght_cuckoo_slot_tag(tags, slot);
+            ght_index_t alt = _ght_cuckoo_alt(step->bucket, tag, cuckoo->mask);
+            
+            if (!tag || alt == step->bucket) continue;
+            
+            queue[tail++] = (ght_cuckoo_step_t) {.bucket = alt, .from = step->bucket, .parent = head, .slot = slot, .depth = step->depth + 1};
+        }
+    }
+    
+    return 0;
+}
+
+static bool _ght_cuckoo_move(ght_table_t* table, ght_cuckoo_t* cuckoo, ght_index_t from, unsigned slot, ght_index_t to, bool lock)
+{
+    if (lock)
+    {
+        _ght_cuckoo_lock_pair(table, from, to);
+    }
+    
+    // The path was found without locks, only move an entry that still belongs to both buckets into a slot still free.
+    uint8_t tag = _ght_cuckoo_slot_tag(cuckoo->tags[from], slot);
+    int free_slot = _ght_cuckoo_free_slot(cuckoo, to);
+    bool moved = (!lock || table->cuckoo == cuckoo) && tag && _ght_cuckoo_alt(from, tag, cuckoo->mask) == to && free_slot >= 0;
+    
+    if (moved)
+    {
+        _ght_cuckoo_store(cuckoo, to, (unsigned) free_slot, cuckoo->buckets[from].keys[slot], cuckoo->buckets[from].data[slot], tag);
+        _ght_cuckoo_set_tag(cuckoo, from, slot, 0);
+    }
+    
+    if (lock)
+    {
+        _ght_cuckoo_unlock_pair(table, from, to);
+    }
+    
+    return moved;
+}
+
+static int _ght_cuckoo_make_room(ght_table_t* table, ght_cuckoo_t* cuckoo, ght_index_t first, ght_index_t second, bool lock)
+{
+    ght_cuckoo_step_t path[GHT_CUCKOO_DEPTH + 1];
+    size_t length = _ght_cuckoo_search_path(cuckoo, first, second, path);
+    
+    if (!length) return GHT_CUCKOO_FULL;
+    
+    // Moves run from the free slot back towards the starting bucket, so every entry always sits in one of its buckets.
+    for (size_t i = 0; i + 1 < length; i++)
+    {
+        if (!_ght_cuckoo_move(table, cuckoo, path[i].from, path[i].slot, path[i].bucket, lock)) return GHT_CUCKOO_RETRY;
+    }
+    
+    return GHT_CUCKOO_DONE;
+}
+
+static ght_status_t _ght_cuckoo_create(ght_table_t* table, ght_width_t width, size_t lock_count)
+{
+    table->lock_count = 1;
+    
+    while (table->lock_count < (lock_count ? lock_count : GHT_CUCKOO_LOCKS))
+    {
+        table->lock_count <<= 1;
+    }
+    
+    table->locks = _ght_aligned_alloc(&table->allocator, GHT_CACHE_LINE, table->lock_count * sizeof(ght_cuckoo_lock_t));
+    
+    if (!table->locks)
+    {
+        table->lock_count = 0;
+        return -1;
+    }
+    
+    for (size_t i = 0; i < table->lock_count; i++)
+    {
+        atomic_init(&table->locks[i].version, 0);
+        atomic_init(&table->locks[i].load, 0);
+    }
+    
+    table->cuckoo = _ght_cuckoo_alloc(table, width);
+    
+    if (!table->cuckoo) return -1;
+    
+    table->width = (table->cuckoo->mask + 1) * GHT_CUCKOO_WAYS;
+    
+    return 0;
+}
+
+static void _ght_cuckoo_destroy(ght_table_t* table)
+{
+    _ght_ebr_flush(table);
+    
+    ght_cuckoo_t* cuckoo = table->cuckoo;
+    
+    for (ght_index_t i = 0; cuckoo && table->deallocator && i <= cuckoo->mask; i++)
+    {
+        for (unsigned slot = 0; slot < GHT_CUCKOO_WAYS; slot++)
+        {
+            if (_ght_cuckoo_slot_tag(cuckoo->tags[i], slot))
+            {
+                table->deallocator(cuckoo->buckets[i].keys[slot], cuckoo->buckets[i].data[slot]);
+            }
+        }
+    }
+    
+    _ght_cuckoo_free(table, cuckoo);
+    _ght_aligned_free(&table->allocator, table->locks);
+    table->cuckoo = NULL;
+    table->locks = NULL;
+    table->lock_count = 0;
+}
+
+static ght_status_t _ght_cuckoo_rehash(ght_table_t* table, ght_width_t width)
+{
+    ght_cuckoo_t* old = table->cuckoo;
+    ght_cuckoo_t* cuckoo = _ght_cuckoo_alloc(table, width);
+    size_t* loads = _ght_calloc(&table->allocator, table->lock_count, sizeof(size_t));
+    
+    if (!cuckoo || !loads)
+    {
+        _ght_cuckoo_free(table, cuckoo);
+        _ght_free(&table->allocator, loads);
+        return -1;
+    }
+    
+    // Every lock is held and the new arrays are private, so entries are placed without locking.
+    for (ght_index_t i = 0; i <= old->mask; i++)
+    {
+        for (unsigned slot = 0; slot < GHT_CUCKOO_WAYS; slot++)
+        {
+            uint8_t tag = _ght_cuckoo_slot_tag(old->tags[i], slot);
+            
+            if (!tag) continue;
+            
+            ght_key_t key = old->buckets[i].keys[slot];
+            ght_hash_t hash = _ght_cuckoo_mix(_ght_digest(table, key));
+            ght_index_t first = hash & cuckoo->mask;
+            ght_index_t second = _ght_cuckoo_alt(first, tag, cuckoo->mask);
+            ght_index_t bucket;
+            int free_slot = _ght_cuckoo_free_pair(cuckoo, first, second, &bucket);
+            
+            if (free_slot < 0)
+            {
+                // Too small for the entries, or a digestor that collides far beyond chance. Keep the old arrays.
+                if (_ght_cuckoo_make_room(table, cuckoo, first, second, false) != GHT_CUCKOO_DONE)
+                {
+                    _ght_cuckoo_free(table, cuckoo);
+                    _ght_free(&table->allocator, loads);
+                    return -1;
+                }
+                
+                free_slot = _ght_cuckoo_free_pair(cuckoo, first, second, &bucket);
+            }
+            
+            _ght_cuckoo_store(cuckoo, bucket, (unsigned) free_slot, key, old->buckets[i].data[slot], tag);
+            loads[first & (table->lock_count - 1)]++;
+        }
+    }
+    
+    for (size_t i = 0; i < table->lock_count; i++)
+    {
+        atomic_store_explicit(&table->locks[i].load, loads[i], memory_order_relaxed);
+    }
+    
+    _ght_free(&table->allocator, loads);
+    
+    GHT_PUBLISH(table->cuckoo, cuckoo);
+    __atomic_store_n(&table->width, (cuckoo->mask + 1) * GHT_CUCKOO_WAYS, __ATOMIC_RELAXED);
+    
+    return 0;
+}
+
+static ght_status_t _ght_cuckoo_resize(ght_table_t* table, ght_width_t expected, ght_width_t width)
+{
+    for (size_t i = 0; i < table->lock_count; i++)
+    {
+        _ght_cuckoo_lock(&table->locks[i]);
+    }
+    
+    // A grow only proceeds if no other writer grew the arrays while this one waited for the locks. The width is
+    // compared rather than the array, whose address a reclaimed array may have passed on to its successor.
+    ght_cuckoo_t* old = table->cuckoo;
+    ght_status_t status = !expected || (old->mask + 1) * GHT_CUCKOO_WAYS == expected ? _ght_cuckoo_rehash(table, width) : 0;
+    
+    for (size_t i = table->lock_count; i > 0; i--)
+    {
+        _ght_cuckoo_unlock(&table->locks[i - 1]);
+    }
+    
+    // Retired only now, lookups spinning on the locks could otherwise hold up a grace period waited for under them.
+    if (table->cuckoo != old)
+    {
+        _ght_ebr_retire(table, _ght_reclaim_cuckoo, old, 0);
+        _ght_ebr_drain();
+    }
+    
+    return status;
+}
+
+static int _ght_cuckoo_try_insert(ght_table_t* table, ght_cuckoo_t* cuckoo, ght_hash_t hash, ght_key_t key, ght_data_t data)
+{
+    uint8_t tag = _ght_cuckoo_tag(hash);
+    ght_index_t first = hash & cuckoo->mask;
+    ght_index_t second = _ght_cuckoo_alt(first, tag, cuckoo->mask);
+    ght_cuckoo_lock_t* lock = _ght_cuckoo_lock_of(table, first);
+    
+    _ght_cuckoo_lock_pair(table, first, second);
+    
+    if (table->cuckoo != cuckoo)
+    {
+        _ght_cuckoo_unlock_pair(table, first, second);
+        return GHT_CUCKOO_RETRY;
+    }
+    
+    ght_index_t bucket;
+    int slot = _ght_cuckoo_find_pair(cuckoo, first, second, key, tag, &bucket);
+    
+    if (slot >= 0)
+    {
+        if (table->deallocator)
+        {
+            table->deallocator(key, cuckoo->buckets[bucket].data[slot]);
+        }
+        
+        __atomic_store_n(&cuckoo->buckets[bucket].data[slot], data, __ATOMIC_RELAXED);
+        
+        _ght_cuckoo_unlock_pair(table, first, second);
+        return GHT_CUCKOO_DONE;
+    }
+    
+    // Like a striped table, extrapolate the load from this lock's counter.
+    size_t load = atomic_load_explicit(&lock->load, memory_order_relaxed);
+    ght_width_t width = (cuckoo->mask + 1) * GHT_CUCKOO_WAYS;
+    
+    if (table->auto_resize > 0.0 && (ght_load_factor_t) ((load + 1) * _ght_cuckoo_locks_used(table, cuckoo)) / (ght_load_factor_t) width > table->auto_resize)
+    {
+        _ght_cuckoo_unlock_pair(table, first, second);
+        return GHT_CUCKOO_GROW;
+    }
+    
+    slot = _ght_cuckoo_free_pair(cuckoo, first, second, &bucket);
+    
+    if (slot >= 0)
+    {
+        _ght_cuckoo_store(cuckoo, bucket, (unsigned) slot, key, data, tag);
+        atomic_store_explicit(&lock->load, load + 1, memory_order_relaxed);
+        
+        _ght_cuckoo_unlock_pair(table, first, second);
+        return GHT_CUCKOO_DONE;
+    }
+    
+    _ght_cuckoo_unlock_pair(table, first, second);
+    
+    // Both buckets are full, free a slot along a displacement path and try again.
+    return _ght_cuckoo_make_room(table, cuckoo, first, second, true) == GHT_CUCKOO_FULL ? GHT_CUCKOO_FULL : GHT_CUCKOO_RETRY;
+}
+
+static ght_status_t _ght_cuckoo_insert(ght_table_t* table, ght_hash_t hash, ght_key_t key, ght_data_t data)
+{
+    hash = _ght_cuckoo_mix(hash);
+    bool grown = false;
+    
+    for (;;)
+    {
+        ght_ebr_record_t* reader = _ght_ebr_enter();
+        
+        if (!reader) return -1;
+        
+        ght_cuckoo_t* cuckoo = GHT_CONSUME(table->cuckoo);
+        ght_width_t width = (cuckoo->mask + 1) * GHT_CUCKOO_WAYS;
+        int result = _ght_cuckoo_try_insert(table, cuckoo, hash, key, data);
+        
+        // Growing waits for a grace period, which would never end while this thread is still a reader.
+        _ght_ebr_exit(reader);
+        
+        if (result == GHT_CUCKOO_DONE) return 0;
+        if (result == GHT_CUCKOO_RETRY) continue;
+        
+        // A key that still finds no room after doubling collides with too many others for any size to help.
+        if (result == GHT_CUCKOO_FULL && grown) return -1;
+        if (_ght_cuckoo_resize(table, width, width * 2)) return -1;
+        
+        grown |= result == GHT_CUCKOO_FULL;
+    }
+}
+
+static bool _ght_cuckoo_lookup(ght_table_t* table, ght_hash_t hash, ght_key_t key, ght_data_t* data)
+{
+    uint8_t tag = _ght_cuckoo_tag(hash);
+    
+    // The caller is a reader, so arrays replaced by a resize stay allocated until it leaves.
+    for (;;)
+    {
+        ght_cuckoo_t* cuckoo = GHT_CONSUME(table->cuckoo);
+        ght_index_t first = hash & cuckoo->mask;
+        ght_index_t second = _ght_cuckoo_alt(first, tag, cuckoo->mask);
+        ght_cuckoo_lock_t* first_lock = _ght_cuckoo_lock_of(table, first);
+        ght_cuckoo_lock_t* second_lock = _ght_cuckoo_lock_of(table, second);
+        size_t first_version = _ght_cuckoo_read_begin(first_lock);
+        size_t second_version = _ght_cuckoo_read_begin(second_lock);
+        
+        ght_index_t bucket;
+        int slot = _ght_cuckoo_find_pair(cuckoo, first, second, key, tag, &bucket);
+        
+        *data = slot >= 0 ? __atomic_load_n(&cuckoo->buckets[bucket].data[slot], __ATOMIC_RELAXED) : 0;
+        
+        // Optimistic read: valid only if no writer locked either bucket and no resize replaced the arrays meanwhile.
+        atomic_thread_fence(memory_order_acquire);
+        
+        if (atomic_load_explicit(&first_lock->version, memory_order_relaxed) == first_version
+            && atomic_load_explicit(&second_lock->version, memory_order_relaxed) == second_version
+            && __atomic_load_n(&table->cuckoo, __ATOMIC_RELAXED) == cuckoo)
+        {
+            return slot >= 0;
+        }
+    }
+}
+
+static ght_data_t _ght_cuckoo_search(ght_table_t* table, ght_hash_t hash, ght_key_t key)
+{
+    hash = _ght_cuckoo_mix(hash);
+    ght_data_t data;
+    
+    ght_ebr_record_t* reader = _ght_ebr_enter();
+    
+    if (!reader) return 0;
+    
+    _ght_cuckoo_lookup(table, hash, key, &data);
+    _ght_ebr_exit(reader);
+    
+    return data;
+}
+
+static size_t _ght_cuckoo_search_batch(ght_table_t* table, const ght_key_t* keys, ght_data_t* data, bool* found, size_t count)
+{
+    size_t hits = 0;
+    ght_ebr_record_t* reader = _ght_ebr_enter();
+    
+    if (!reader)
+    {
+        memset(data, 0, count * sizeof(ght_data_t));
+        if (found) memset(found, 0, count * sizeof(bool));
+        return 0;
+    }
+    
+    for (size_t base = 0; base < count; base += GHT_BATCH)
+    {
+        size_t batch = count - base < GHT_BATCH ? count - base : GHT_BATCH;
+        ght_cuckoo_t* cuckoo = GHT_CONSUME(table->cuckoo);
+        ght_hash_t hashes[GHT_BATCH];
+        
+        // Fetch both candidate buckets of every key before looking any of them up.
+        for (size_t i = 0; i < batch; i++)
+        {
+            hashes[i] = _ght_cuckoo_mix(_ght_digest(table, keys[base + i]));
+            
+            ght_index_t first = hashes[i] & cuckoo->mask;
+            ght_index_t second = _ght_cuckoo_alt(first, _ght_cuckoo_tag(hashes[i]), cuckoo->mask);
+            
+            __builtin_prefetch(&cuckoo->tags[first]);
+            __builtin_prefetch(&cuckoo->buckets[first]);
+            __builtin_prefetch(&cuckoo->tags[second]);
+            __builtin_prefetch(&cuckoo->buckets[second]);
+        }
+        
+        for (size_t i = 0; i < batch; i++)
+        {
+            bool hit = _ght_cuckoo_lookup(table, hashes[i], keys[base + i], &data[base + i]);
+            
+            hits += hit;
+            if (found) found[base + i] = hit;
+        }
+    }
+    
+    _ght_ebr_exit(reader);
+    return hits;
+}
+
+static ght_status_t _ght_cuckoo_delete(ght_table_t* table, ght_hash_t hash, ght_key_t key)
+{
+    hash = _ght_cuckoo_mix(hash);
+    uint8_t tag = _ght_cuckoo_tag(hash);
+    
+    for (;;)
+    {
+        ght_ebr_record_t* reader = _ght_ebr_enter();
+        
+        if (!reader) return -1;
+        
+        ght_cuckoo_t* cuckoo = GHT_CONSUME(table->cuckoo);
+        ght_index_t first = hash & cuckoo->mask;
+        ght_index_t second = _ght_cuckoo_alt(first, tag, cuckoo->mask);
+        
+        _ght_cuckoo_lock_pair(table, first, second);
+        
+        if (table->cuckoo != cuckoo)
+        {
+            _ght_cuckoo_unlock_pair(table, first, second);
+            _ght_ebr_exit(reader);
+            continue;
+        }
+        
+        ght_index_t bucket;
+        int slot = _ght_cuckoo_find_pair(cuckoo, first, second, key, tag, &bucket);
+        
+        if (slot >= 0)
+        {
+            ght_cuckoo_lock_t* lock = _ght_cuckoo_lock_of(table, first);
+            
+            _ght_cuckoo_set_tag(cuckoo, bucket, (unsigned) slot, 0);
+            atomic_store_explicit(&lock->load, atomic_load_explicit(&lock->load, memory_order_relaxed) - 1, memory_order_relaxed);
+            
+            if (table->deallocator)
+            {
+                table->deallocator(key, cuckoo->buckets[bucket].data[slot]);
+            }
+        }
+        
+        _ght_cuckoo_unlock_pair(table, first, second);
+        _ght_ebr_exit(reader);
+        
+        return slot >= 0 ? 0 : -1;
+    }
+}
+
+static GHT_FORCE_INLINE ght_hash_t _ght_lf_reverse(ght_hash_t hash)
+{
+    uint64_t bits = hash;
+    
+    bits = ((bits >> 1) & 0x5555555555555555ULL) | ((bits & 0x5555555555555555ULL) << 1);
+    bits = ((bits >> 2) & 0x3333333333333333ULL) | ((bits & 0x3333333333333333ULL) << 2);
+    bits = ((bits >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((bits & 0x0f0f0f0f0f0f0f0fULL) << 4);
+    
+    return (ght_hash_t) (__builtin_bswap64(bits) >> (64 - GHT_HASH_BITS));
+}
+
+static GHT_FORCE_INLINE unsigned _ght_lf_top_bit(ght_index_t index)
+{
+    return 63 - __builtin_clzll((unsigned long long) index);
+}
+
+static ght_bucket_t** _ght_lf_slot(ght_lf_table_t* lf, ght_index_t index, bool create)
+{
+    size_t segment = 0;
+    ght_width_t length = lf->base;
+    
+    // Segment s > 0 holds buckets [base << (s - 1), base << s).
+    if (index >= lf->base)
+    {
+        unsigned top = _ght_lf_top_bit(index);
+        
+        segment = top - lf->base_bits + 1;
+        length = (ght_width_t) 1 << top;
+        index -= length;
+    }
+    
+    ght_bucket_t** slots = __atomic_load_n(&lf->segments[segment], __ATOMIC_ACQUIRE);
+    
+    if (!slots && create)
+    {
+        ght_bucket_t** expected = NULL;
+        
+        slots = _ght_calloc(&lf->table.allocator, length, sizeof(ght_bucket_t*));
+        
+        if (!slots) return NULL;
+        
+        if (!__atomic_compare_exchange_n(&lf->segments[segment], &expected, slots, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            _ght_free(&lf->table.allocator, slots);
+            slots = expected;
+        }
+    }
+    
+    return slots ? &slots[index] : NULL;
+}
+
+static bool _ght_lf_find(ght_lf_table_t* lf, ght_bucket_t* head, ght_hash_t order, ght_key_t key, ght_bucket_t*** prev, ght_bucket_t** curr)
+{
+    bool restart;
+    
+    // Harris-Michael search: stop at the first node not ordered before (order, key), unlinking deleted nodes on the way.
+    do
+    {
+        restart = false;
+        *prev = &head->next;
+        *curr = GHT_CONSUME(head->next);
+        
+        while (*curr)
+        {
+            ght_bucket_t* next = GHT_CONSUME((*curr)->next);
+            
+            if (GHT_LF_MARKED(next))
+            {
+                ght_bucket_t* expected = *curr;
+                
+                // The predecessor was deleted or changed under us, its next pointer can no longer be trusted.
+                if (!__atomic_compare_exchange_n(*prev, &expected, GHT_LF_NEXT(next), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                {
+                    restart = true;
+                    break;
+                }
+                
+                _ght_ebr_retire(&lf->table, _ght_reclaim_bucket, *curr, 0);
+                *curr = GHT_LF_NEXT(next);
+                continue;
+            }
+            
+            if ((*curr)->hash > order || ((*curr)->hash == order && (*curr)->key >= key)) break;
+            
+            *prev = &(*curr)->next;
+            *curr = next;
+        }
+    } while (restart);
+    
+    return *curr && (*curr)->hash == order && (*curr)->key == key;
+}
+
+static ght_bucket_t* _ght_lf_sentinel(ght_lf_table_t* lf, ght_index_t index)
+{
+    ght_bucket_t** slot = _ght_lf_slot(lf, index, true);
+    
+    if (!slot) return NULL;
+    
+    ght_bucket_t* sentinel = GHT_CONSUME(*slot);
+    
+    if (sentinel) return sentinel;
+    
+    // A bucket splits off the bucket equal to its index without the top bit, whose sentinel precedes it in the list.
+    ght_bucket_t* parent = _ght_lf_sentinel(lf, index & ~((ght_index_t) 1 << _ght_lf_top_bit(index)));
+    
+    if (!parent || !(sentinel = _ght_bucket_alloc(&lf->table))) return NULL;
+    
+    sentinel->hash = _ght_lf_reverse(index);
+    
+    ght_bucket_t** prev;
+    ght_bucket_t* curr;
+    
+    while (true)
+    {
+        // Another thread linked the same sentinel first.
+        if (_ght_lf_find(lf, parent, sentinel->hash, 0, &prev, &curr))
+        {
+            _ght_bucket_free(&lf->table, sentinel);
+            sentinel = curr;
+            break;
+        }
+        
+        sentinel->next = curr;
+        
+        if (__atomic_compare_exchange_n(prev, &curr, sentinel, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) break;
+    }
+    
+    GHT_PUBLISH(*slot, sentinel);
+    return sentinel;
+}
+
+static ght_bucket_t* _ght_lf_head(ght_lf_table_t* lf, ght_hash_t hash, bool create)
+{
+    ght_index_t index = hash & (atomic_load_explicit(&lf->size, memory_order_acquire) - 1);
+    ght_bucket_t* sentinel = create ? _ght_lf_sentinel(lf, index) : NULL;
+    
+    // Searches, and writers out of memory, start from the closest initialized ancestor, whose sublist contains this bucket's.
+    while (!sentinel)
+    {
+        ght_bucket_t** slot = _ght_lf_slot(lf, index, false);
+        
+        if (slot && (sentinel = GHT_CONSUME(*slot))) break;
+        
+        index &= ~((ght_index_t) 1 << _ght_lf_top_bit(index));
+    }
+    
+    return sentinel;
+}
+
+static GHT_FORCE_INLINE ght_table_t* _ght_shard(ght_sharded_t* sharded, ght_hash_t hash)
+{
+    // The top bits pick the shard, so the bits a shard indexes its buckets with stay evenly spread within it.
+    return sharded->shards[sharded->bits ? hash >> (GHT_HASH_BITS - sharded->bits) : 0];
+}
+
+static GHT_FORCE_INLINE ght_bucket_t** _ght_chain(ght_table_t* table, ght_hash_t hash)
+{
+    // While migrating, a key lives in the old array until its old bucket has been moved.
+    if (table->old_buckets)
+    {
+        ght_index_t index = _ght_index(table->index_policy, hash, table->old_width, table->old_magic);
+        
+        if (table->resize_mode == GHT_RESIZE_COOPERATIVE ? table->old_buckets[index] != GHT_FORWARDED : index >= table->migrated)
+        {
+            return &table->old_buckets[index];
+        }
+    }
+    
+    return &table->buckets[_ght_index(table->index_policy, hash, table->width, table->magic)];
+}
+
+static void _ght_migrate(ght_table_t* table, size_t count)
+{
+    size_t empty = count * GHT_MIGRATE_EMPTY;
+    
+    while (count && table->migrated < table->old_width)
+    {
+        ght_bucket_t* bucket = table->old_buckets[table->migrated];
+        
+        if (!bucket)
+        {
+            table->migrated++;
+            
+            if (!--empty) break;
+            
+            continue;
+        }
+        
+        while (bucket)
+        {
+            ght_bucket_t* next = bucket->next;
+            ght_index_t index = _ght_index(table->index_policy, bucket->hash, table->width, table->magic);
+            
+            bucket->next = table->buckets[index];
+            table->buckets[index] = bucket;
+            bucket = next;
+        }
+        
+        table->old_buckets[table->migrated++] = NULL;
+        count--;
+    }
+    
+    if (table->migrated == table->old_width)
+    {
+        _ght_free(&table->allocator, table->old_buckets);
+        table->old_buckets = NULL;
+        table->old_width = 0;
+        table->migrated = 0;
+    }
+}
+
+static bool _ght_transfer_bucket(ght_table_t* table, ght_index_t index)
+{
+    ght_bucket_t* bucket = table->old_buckets[index];
+    
+    if (bucket == GHT_FORWARDED) return false;
+    
+    // Keys of one old bucket land in new buckets covered by the same lock, which the caller holds.
+    while (bucket)
+    {
+        ght_bucket_t* next = bucket->next;
+        ght_index_t new_index = _ght_index(table->index_policy, bucket->hash, table->width, table->magic);
+        
+        bucket->next = table->buckets[new_index];
+        table->buckets[new_index] = bucket;
+        bucket = next;
+    }
+    
+    table->old_buckets[index] = GHT_FORWARDED;
+    
+    // True for the bucket that completes the transfer.
+    return atomic_fetch_add_explicit(&table->transferred, 1, memory_order_relaxed) + 1 == table->old_width;
+}
+
+static void _ght_transfer_all(ght_table_t* table)
+{
+    if (!table->old_buckets) return;
+    
+    for (ght_index_t i = 0; i < table->old_width; i++)
+    {
+        _ght_transfer_bucket(table, i);
+    }
+    
+    _ght_free(&table->allocator, table->old_buckets);
+    __atomic_store_n(&table->old_buckets, NULL, __ATOMIC_RELAXED);
+    __atomic_store_n(&table->old_width, 0, __ATOMIC_RELAXED);
+}
+
+static void _ght_transfer_help(ght_table_t* table, size_t strides)
+{
+    bool done = false;
+    bool claimed = true;
+    
+    while (strides-- && claimed)
+    {
+        size_t start = atomic_fetch_add_explicit(&table->transfer, GHT_TRANSFER_STRIDE, memory_order_relaxed);
+        
+        for (ght_index_t i = start; claimed && i < start + GHT_TRANSFER_STRIDE; i++)
+        {
+            ght_width_t width = __atomic_load_n(&table->old_width, __ATOMIC_RELAXED);
+            
+            if (i >= width)
+            {
+                claimed = false;
+                break;
+            }
+            
+            mtx_t* mutex = _ght_bucket_lock(table, i, width);
+            mtx_lock(mutex);
+            
+            // The transfer may have been finished, or replaced by the next one, while this thread waited.
+            claimed = table->old_buckets && table->old_width == width;
+            done |= claimed && _ght_transfer_bucket(table, i);
+            
+            mtx_unlock(mutex);
+        }
+    }
+    
+    if (!done) return;
+    
+    // Lookups read old buckets under their own lock, so the old array goes away under all of them.
+    _ght_lock_all(table);
+    
+    if (table->old_buckets && atomic_load_explicit(&table->transferred, memory_order_relaxed) == table->old_width)
+    {
+        _ght_transfer_all(table);
+    }
+    
+    _ght_unlock_all(table);
+}
+
+static GHT_FORCE_INLINE ght_bucket_t* _ght_bucket_alloc(ght_table_t* table)
+{
+    if (!table->pool) return _ght_calloc(&table->allocator, 1, table->node_size);
+    
+    ght_bucket_t* bucket = _ght_pool_alloc(table->pool);
+    
+    // Recycled nodes still carry the length of their previous key.
+    if (bucket && table->key_mode == GHT_KEY_BYTES)
+    {
+        ((ght_bytes_bucket_t*) bucket)->length = 0;
+    }
+    
+    return bucket;
+}
+
+static GHT_FORCE_INLINE void _ght_bucket_free(ght_table_t* table, ght_bucket_t* bucket)
+{
+    if (table->pool)
+    {
+        _ght_pool_free(table->pool, bucket);
+    }
+    else
+    {
+        _ght_free(&table->allocator, bucket);
+    }
+}
+
+static GHT_FORCE_INLINE void _ght_bucket_release(ght_table_t* table, ght_bucket_t* bucket)
+{
+    _ght_bucket_set_key(table, bucket, 0, 0);
+    _ght_bucket_free(table, bucket);
+}
+
+static GHT_FORCE_INLINE const void* _ght_bytes_key(ght_table_t* table, ght_bucket_t* bucket)
+{
+    ght_bytes_bucket_t* bytes = (ght_bytes_bucket_t*) bucket;
+    
+    return bytes->length <= table->key_inline ? bytes->inline_key : (const void*) bucket->key;
+}
+
+static GHT_FORCE_INLINE ght_status_t _ght_bucket_set_key(ght_table_t* table, ght_bucket_t* bucket, ght_key_t key, size_t length)
+{
+    if (table->key_mode != GHT_KEY_BYTES)
+    {
+        bucket->key = key;
+        return 0;
+    }
+    
+    // Replacing a key frees the previous out-of-line copy, so (0, 0) releases it.
+    ght_bytes_bucket_t* bytes = (ght_bytes_bucket_t*) bucket;
+    
+    if (bytes->length > table->key_inline)
+    {
+        _ght_free(&table->allocator, (void*) bucket->key);
+    }
+    
+    bytes->length = 0;
+    
+    if (length <= table->key_inline)
+    {
+        if (length)
+        {
+            memcpy(bytes->inline_key, (const void*) key, length);
+        }
+    }
+    else
+    {
+        void* copy = _ght_malloc(&table->allocator, length);
+        
+        if (!copy) return -1;
+        
+        memcpy(copy, (const void*) key, length);
+        bucket->key = (ght_key_t) copy;
+    }
+    
+    bytes->length = length;
+    return 0;
+}
+
+static GHT_FORCE_INLINE ght_key_t _ght_bucket_key(ght_table_t* table, ght_bucket_t* bucket)
+{
+    return table->key_mode == GHT_KEY_BYTES ? (ght_key_t) _ght_bytes_key(table, bucket) : bucket->key;
+}
+
+static GHT_FORCE_INLINE bool _ght_match(ght_table_t* table, ght_bucket_t* bucket, ght_hash_t hash, ght_key_t key, size_t length)
+{
+    if (table->key_mode != GHT_KEY_BYTES) return key == bucket->key;
+    
+    // The cached hash and the length reject nearly every mismatch without touching the key bytes.
+    return bucket->hash == hash && ((ght_bytes_bucket_t*) bucket)->length == length
+           && table->comparator(_ght_bytes_key(table, bucket), (const void*) key, length);
+}
+
+static void _ght_ebr_init(void)
+{
+    _ght_ebr_key_ready = thrd_success == tss_create(&_ght_ebr_key, _ght_ebr_release);
+}
+
+static ght_ebr_record_t* _ght_ebr_register(void)
+{
+    if (_ght_ebr_self) return _ght_ebr_self;
+    
+    call_once(&_ght_ebr_once, _ght_ebr_init);
+    
+    ght_ebr_record_t* record;
+    
+    // Records of exited threads are reused first, along with whatever they still hold in limbo.
+    for (record = GHT_CONSUME(_ght_ebr_records); record; record = record->next)
+    {
+        if (!atomic_load_explicit(&record->used, memory_order_relaxed)
+            && !atomic_exchange_explicit(&record->used, true, memory_order_acquire))
+        {
+            break;
+        }
+    }
+    
+    // Records are never freed and outlive every table, so they come from the C library rather than a table's allocator.
+    if (!record)
+    {
+        record = aligned_alloc(GHT_CACHE_LINE, sizeof(ght_ebr_record_t));
+        
+        if (!record) return NULL;
+        
+        memset(record, 0, sizeof(ght_ebr_record_t));
+        atomic_init(&record->state, 0);
+        atomic_flag_clear(&record->lock);
+        atomic_init(&record->used, true);
+        record->next = GHT_CONSUME(_ght_ebr_records);
+        
+        while (!__atomic_compare_exchange_n(&_ght_ebr_records, &record->next, record, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+    
+    _ght_ebr_self = record;
+    
+    if (_ght_ebr_key_ready)
+    {
+        tss_set(_ght_ebr_key, record);
+    }
+    
+    return record;
+}
+
+static GHT_FORCE_INLINE ght_ebr_record_t* _ght_ebr_record(void)
+{
+    ght_ebr_record_t* record = _ght_ebr_self;
+    
+    // NULL when no record could be allocated, the caller fails its operation rather than read unprotected.
+    return record ? record : _ght_ebr_register();
+}
+
+static GHT_FORCE_INLINE void _ght_ebr_lock(ght_ebr_record_t* record)
+{
+    while (atomic_flag_test_and_set_explicit(&record->lock, memory_order_acquire))
+    {
+        thrd_yield();
+    }
+}
+
+static GHT_FORCE_INLINE void _ght_ebr_unlock(ght_ebr_record_t* record)
+{
+    atomic_flag_clear_explicit(&record->lock, memory_order_release);
+}
+
+static GHT_FORCE_INLINE ght_ebr_record_t* _ght_ebr_enter(void)
+{
+    ght_ebr_record_t* record = _ght_ebr_record();
+    
+    if (!record) return NULL;
+    
+    if (!record->depth++)
+    {
+        size_t epoch = atomic_load_explicit(&_ght_ebr_epoch, memory_order_acquire);
+        
+        // Sequentially consistent so the announcement is ordered before every shared load that follows.
+        atomic_exchange_explicit(&record->state, (epoch << 1) | 1, memory_order_seq_cst);
+    }
+    
+    return record;
+}
+
+static GHT_FORCE_INLINE void _ght_ebr_exit(ght_ebr_record_t* record)
+{
+    if (!--record->depth)
+    {
+        atomic_store_explicit(&record->state, 0, memory_order_release);
+    }
+}
+
+static bool _ght_ebr_advance(void)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    
+    size_t epoch = atomic_load_explicit(&_ght_ebr_epoch, memory_order_seq_cst);
+    
+    // A thread still reading in an older epoch may hold anything retired since.
+    for (ght_ebr_record_t* record = GHT_CONSUME(_ght_ebr_records); record; record = record->next)
+    {
+        size_t state = atomic_load_explicit(&record->state, memory_order_acquire);
+        
+        if ((state & 1) && (state >> 1) != epoch) return false;
+    }
+    
+    atomic_compare_exchange_strong_explicit(&_ght_ebr_epoch, &epoch, epoch + 1, memory_order_seq_cst, memory_order_relaxed);
+    return true;
+}
+
+static void _ght_ebr_synchronize(void)
+{
+    size_t target = atomic_load_explicit(&_ght_ebr_epoch, memory_order_seq_cst) + 2;
+    
+    while (atomic_load_explicit(&_ght_ebr_epoch, memory_order_acquire) < target)
+    {
+        if (!_ght_ebr_advance())
+        {
+            thrd_yield();
+        }
+    }
+}
+
+static void _ght_ebr_reclaim(ght_retired_t* item)
+{
+    ght_table_t* table = item->table;
+    
+    item->reclaim(table, item->ptr, item->size);
+    
+    // Last touch of the table, a flush waiting for pending to drain may free it right after.
+    atomic_fetch_sub_explicit(&table->pending, 1, memory_order_release);
+}
+
+static size_t _ght_ebr_detach(ght_ebr_record_t* record, size_t epoch, ght_limbo_t* detached)
+{
+    size_t count = 0;
+    
+    // Items retired two epochs before the current one predate every read section still running.
+    for (unsigned i = 0; i < GHT_EBR_BAGS; i++)
+    {
+        ght_limbo_t* limbo = &record->limbo[i];
+        
+        if (limbo->count && limbo->epoch + 2 <= epoch)
+        {
+            detached[count++] = *limbo;
+            __atomic_store_n(&record->count, record->count - limbo->count, __ATOMIC_RELAXED);
+            *limbo = (ght_limbo_t) {0};
+        }
+    }
+    
+    return count;
+}
+
+static void _ght_ebr_reclaim_detached(ght_limbo_t* detached, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        for (size_t j = 0; j < detached[i].count; j++)
+        {
+            _ght_ebr_reclaim(&detached[i].items[j]);
+        }
+        
+        _ght_ebr_free_items(&detached[i]);
+    }
+}
+
+static void _ght_ebr_release(void* ptr)
+{
+    ght_ebr_record_t* record = ptr;
+    ght_limbo_t detached[GHT_EBR_BAGS];
+    
+    // Hand the record back empty so nothing this thread retired waits on another thread to run.
+    if (__atomic_load_n(&record->count, __ATOMIC_RELAXED))
+    {
+        _ght_ebr_synchronize();
+        _ght_ebr_lock(record);
+        
+        size_t count = _ght_ebr_detach(record, SIZE_MAX, detached);
+        
+        _ght_ebr_unlock(record);
+        _ght_ebr_reclaim_detached(detached, count);
+    }
+    
+    _ght_ebr_self = NULL;
+    atomic_store_explicit(&record->used, false, memory_order_release);
+}
+
+static void _ght_ebr_retire(ght_table_t* table, void (*reclaim)(ght_table_t*, void*, size_t), void* ptr, size_t size)
+{
+    ght_ebr_record_t* record = _ght_ebr_record();
+    ght_limbo_t* limbo;
+    
+    atomic_fetch_add_explicit(&table->pending, 1, memory_order_relaxed);
+    
+    // Without a record the thread cannot be reading either, so it can wait for the other readers right away.
+    if (!record)
+    {
+        _ght_ebr_synchronize();
+        _ght_ebr_reclaim(&(ght_retired_t) {.table = table, .reclaim = reclaim, .ptr = ptr, .size = size});
+        return;
+    }
+    
+    while (true)
+    {
+        _ght_ebr_lock(record);
+        
+        // Read after the caller unlinked ptr, so readers of any later epoch cannot have seen it.
+        size_t epoch = atomic_load_explicit(&_ght_ebr_epoch, memory_order_acquire);
+        
+        limbo = &record->limbo[epoch % GHT_EBR_BAGS];
+        
+        // Items left over from three epochs ago only wait longer under the current epoch, never less.
+        limbo->epoch = epoch;
+        
+        if (limbo->count < limbo->capacity) break;
+        
+        if (_ght_ebr_move_items(limbo, table, limbo->capacity ? limbo->capacity * 2 : GHT_RETIRE_BATCH)) break;
+        
+        _ght_ebr_unlock(record);
+        
+        // Out of memory, wait for the readers right here instead of deferring. Inside a read section that
+        // wait would never end, so only memory can unblock it.
+        if (!record->depth)
+        {
+            _ght_ebr_synchronize();
+            _ght_ebr_reclaim(&(ght_retired_t) {.table = table, .reclaim = reclaim, .ptr = ptr, .size = size});
+            return;
+        }
+        
+        thrd_yield();
+    }
+    
+    limbo->items[limbo->count++] = (ght_retired_t) {.table = table, .reclaim = reclaim, .ptr = ptr, .size = size};
+    __atomic_store_n(&record->count, record->count + 1, __ATOMIC_RELAXED);
+    
+    _ght_ebr_unlock(record);
+}
+
+static bool _ght_ebr_move_items(ght_limbo_t* limbo, ght_table_t* table, size_t capacity)
+{
+    // Arrays come from the allocator of the retiring table, which waits for them in its flush.
+    ght_retired_t* items = _ght_malloc(&table->allocator, capacity * sizeof(ght_retired_t));
+    
+    if (!items) return false;
+    
+    atomic_fetch_add_explicit(&table->pending, 1, memory_order_relaxed);
+    
+    if (limbo->count)
+    {
+        memcpy(items, limbo->items, limbo->count * sizeof(ght_retired_t));
+    }
+    
+    _ght_ebr_free_items(limbo);
+    
+    limbo->items = items;
+    limbo->capacity = capacity;
+    limbo->owner = table;
+    return true;
+}
+
+static void _ght_ebr_free_items(ght_limbo_t* limbo)
+{
+    ght_table_t* owner = limbo->owner;
+    
+    if (!owner) return;
+    
+    _ght_free(&owner->allocator, limbo->items);
+    
+    // Last touch of the owner, a flush waiting for pending to drain may free it right after.
+    atomic_fetch_sub_explicit(&owner->pending, 1, memory_order_release);
+}
+
+static void _ght_ebr_collect(void)
+{
+    ght_ebr_record_t* record = _ght_ebr_self;
+    ght_limbo_t detached[GHT_EBR_BAGS];
+    
+    if (!record || __atomic_load_n(&record->count, __ATOMIC_RELAXED) < GHT_RETIRE_BATCH) return;
+    
+    _ght_ebr_advance();
+    _ght_ebr_lock(record);
+    
+    size_t count = _ght_ebr_detach(record, atomic_load_explicit(&_ght_ebr_epoch, memory_order_acquire), detached);
+    
+    _ght_ebr_unlock(record);
+    _ght_ebr_reclaim_detached(detached, count);
+}
+
+static void _ght_ebr_drain(void)
+{
+    ght_ebr_record_t* record = _ght_ebr_self;
+    ght_limbo_t detached[GHT_EBR_BAGS];
+    
+    if (!record || !__atomic_load_n(&record->count, __ATOMIC_RELAXED)) return;
+    
+    // Everything this thread retired so far becomes old enough once two epochs have passed.
+    _ght_ebr_synchronize();
+    _ght_ebr_lock(record);
+    
+    size_t count = _ght_ebr_detach(record, atomic_load_explicit(&_ght_ebr_epoch, memory_order_acquire), detached);
+    
+    _ght_ebr_unlock(record);
+    _ght_ebr_reclaim_detached(detached, count);
+}
+
+static void _ght_ebr_flush(ght_table_t* table)
+{
+    if (!atomic_load_explicit(&table->pending, memory_order_acquire)) return;
+    
+    _ght_ebr_synchronize();
+    
+    // With the table no longer in use, everything it retired is unreachable now, whichever thread holds it. Items are
+    // taken one at a time so no lock is held while they are reclaimed, and a pass repeats until their owners are done too.
+    while (atomic_load_explicit(&table->pending, memory_order_acquire))
+    {
+        for (ght_ebr_record_t* record = GHT_CONSUME(_ght_ebr_records); record; record = record->next)
+        {
+            for (unsigned i = 0; i < GHT_EBR_BAGS; i++)
+            {
+                ght_limbo_t* limbo = &record->limbo[i];
+                size_t j = 0;
+                
+                _ght_ebr_lock(record);
+                
+                while (j < limbo->count)
+                {
+                    if (limbo->items[j].table != table)
+                    {
+                        j++;
+                        continue;
+                    }
+                    
+                    ght_retired_t item = limbo->items[j];
+                    
+                    limbo->items[j] = limbo->items[--limbo->count];
+                    __atomic_store_n(&record->count, record->count - 1, __ATOMIC_RELAXED);
+                    
+                    _ght_ebr_unlock(record);
+                    _ght_ebr_reclaim(&item);
+                    _ght_ebr_lock(record);
+                }
+                
+                // Items of other tables may be left in an array from this table's allocator, move them out of it.
+                if (limbo->owner == table)
+                {
+                    if (!limbo->count)
+                    {
+                        _ght_ebr_free_items(limbo);
+                        *limbo = (ght_limbo_t) {0};
+                    }
+                    else
+                    {
+                        _ght_ebr_move_items(limbo, limbo->items[0].table, limbo->capacity);
+                    }
+                }
+                
+                _ght_ebr_unlock(record);
+            }
+        }
+        
+        if (atomic_load_explicit(&table->pending, memory_order_acquire))
+        {
+            thrd_yield();
+        }
+    }
+}
+
+static GHT_FORCE_INLINE void _ght_rcu_snapshot(ght_table_t* table, ght_bucket_t*** buckets, ght_width_t* width, uint64_t* magic)
+{
+    size_t sequence;
+    
+    // A resize publishes buckets, width and magic together, retry if one was caught in the middle.
+    do
+    {
+        sequence = atomic_load_explicit(&table->sequence, memory_order_acquire);
+        *buckets = __atomic_load_n(&table->buckets, __ATOMIC_RELAXED);
+        *width = __atomic_load_n(&table->width, __ATOMIC_RELAXED);
+        *magic = __atomic_load_n(&table->magic, __ATOMIC_RELAXED);
+        atomic_thread_fence(memory_order_acquire);
+    } while ((sequence & 1) || sequence != atomic_load_explicit(&table->sequence, memory_order_relaxed));
+}
+
+static ght_data_t _ght_rcu_search(ght_table_t* table, ght_hash_t hash, ght_key_t key, size_t length)
+{
+    ght_ebr_record_t* reader = _ght_ebr_enter();
+    
+    if (!reader) return 0;
+    
+    ght_bucket_t** buckets;
+    ght_width_t width;
+    uint64_t magic;
+    
+    _ght_rcu_snapshot(table, &buckets, &width, &magic);
+    
+    ght_bucket_t* bucket = GHT_CONSUME(buckets[_ght_index(table->index_policy, hash, width, magic)]);
+    
+    while (bucket && !_ght_match(table, bucket, hash, key, length))
+    {
+        bucket = GHT_CONSUME(bucket->next);
+    }
+    
+    ght_data_t data = bucket ? bucket->data : 0;
+    
+    _ght_ebr_exit(reader);
+    return data;
+}
+
+static size_t _ght_rcu_search_batch(ght_table_t* table, const ght_key_t* keys, ght_data_t* data, bool* found, size_t count)
+{
+    ght_ebr_record_t* reader = _ght_ebr_enter();
+    size_t hits = 0;
+    
+    if (!reader)
+    {
+        memset(data, 0, count * sizeof(ght_data_t));
+        if (found) memset(found, 0, count * sizeof(bool));
+        return 0;
+    }
+    
+    ght_bucket_t** buckets;
+    ght_width_t width;
+    uint64_t magic;
+    
+    _ght_rcu_snapshot(table, &buckets, &width, &magic);
+    
+    for (size_t base = 0; base < count; base += GHT_BATCH)
+    {
+        size_t batch = count - base < GHT_BATCH ? count - base : GHT_BATCH;
+        ght_index_t indexes[GHT_BATCH];
+        ght_bucket_t* heads[GHT_BATCH];
+        
+        for (size_t i = 0; i < batch; i++)
+        {
+            indexes[i] = _ght_index(table->index_policy, _ght_digest(table, keys[base + i]), width, magic);
+            __builtin_prefetch(&buckets[indexes[i]]);
+        }
+        
+        for (size_t i = 0; i < batch; i++)
+        {
+            heads[i] = GHT_CONSUME(buckets[indexes[i]]);
+            
+            if (heads[i])
+            {
+                __builtin_prefetch(heads[i]);
+            }
+        }
+        
+        for (size_t i = 0; i < batch; i++)
+        {
+            ght_bucket_t* bucket = heads[i];
+            
+            while (bucket && (keys[base + i] != bucket->key))
+            {
+                bucket = GHT_CONSUME(bucket->next);
+            }
+            
+            data[base + i] = bucket ? bucket->data : 0;
+            
+            hits += bucket != NULL;
+            if (found) found[base + i] = bucket != NULL;
+        }
+    }
+    
+    _ght_ebr_exit(reader);
+    return hits;
+}
+
+static ght_status_t _ght_rcu_rehash(ght_table_t* table, ght_width_t width)
+{
+    // Readers may still walk the old chains, so they are copied rather than relinked.
+    ght_bucket_t** buckets = _ght_calloc(&table->allocator, width, sizeof(ght_bucket_t*));
+    uint64_t magic = _ght_index_magic(table->index_policy, width);
+    
+    if (!buckets) return -1;
+    
+    for (ght_index_t i = 0; i < table->width; i++)
+    {
+        for (ght_bucket_t* bucket = table->buckets[i]; bucket; bucket = bucket->next)
+        {
+            ght_bucket_t* copy = _ght_bucket_alloc(table);
+            
+            if (!copy)
+            {
+                _ght_reclaim_chains(table, buckets, width);
+                return -1;
+            }
+            
+            ght_index_t index = _ght_index(table->index_policy, bucket->hash, width, magic);
+            
+            memcpy(copy, bucket, table->node_size);
+            copy->next = buckets[index];
+            buckets[index] = copy;
+        }
+    }
+    
+    ght_bucket_t** old_buckets = table->buckets;
+    ght_width_t old_width = table->width;
+    size_t sequence = atomic_load_explicit(&table->sequence, memory_order_relaxed);
+    
+    atomic_store_explicit(&table->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    __atomic_store_n(&table->buckets, buckets, __ATOMIC_RELAXED);
+    __atomic_store_n(&table->width, width, __ATOMIC_RELAXED);
+    __atomic_store_n(&table->magic, magic, __ATOMIC_RELAXED);
+    atomic_store_explicit(&table->sequence, sequence + 2, memory_order_release);
+    
+    _ght_ebr_retire(table, _ght_reclaim_chains, old_buckets, old_width);
+    return 0;
+}
+
+static void _ght_reclaim_bucket(ght_table_t* table, void* ptr, size_t size)
+{
+    (void) size;
+    ght_bucket_t* bucket = ptr;
+    
+    if (table->deallocator)
+    {
+        table->deallocator(_ght_bucket_key(table, bucket), bucket->data);
+    }
+    
+    _ght_bucket_release(table, bucket);
+}
+
+static void _ght_reclaim_replaced(ght_table_t* table, void* ptr, size_t size)
+{
+    (void) size;
+    ght_bucket_t* bucket = ptr;
+    
+    // The copy that replaced this node owns its out-of-line key, only the old data goes.
+    if (table->deallocator)
+    {
+        table->deallocator(_ght_bucket_key(table, bucket), bucket->data);
+    }
+    
+    _ght_bucket_free(table, bucket);
 }
 
-static GHT_FORCE_INLINE uint64_t _ght_digestor_murmur3_64(ght_key_t key, uint64_t seed)
+static void _ght_reclaim_cuckoo(ght_table_t* table, void* ptr, size_t size)
 {
-    uint64_t hash = seed;
-    const uint64_t c1 = 0x87c37b91114253d5ULL;
-    const uint64_t c2 = 0x4cf5ad432745937fULL;
+    (void) size;
     
-    uint64_t k1 = key;
+    // The entries moved to the new arrays, only the old storage goes.
+    _ght_cuckoo_free(table, ptr);
+}
+
+static void _ght_reclaim_chains(ght_table_t* table, void* ptr, size_t size)
+{
+    ght_bucket_t** buckets = ptr;
     
-    k1 *= c1;
-    k1 = (k1 << 31) | (k1 >> (64 - 31));  // ROTL64(k1, 31)
-    k1 *= c2;
+    for (ght_index_t i = 0; i < size; i++)
+    {
+        ght_bucket_t* bucket = buckets[i];
+        
+        while (bucket)
+        {
+            ght_bucket_t* next = bucket->next;
+            _ght_bucket_free(table, bucket);
+            bucket = next;
+        }
+    }
+    
+    _ght_free(&table->allocator, buckets);
+}
 
-    hash ^= k1;
-    hash = (hash << 27) | (hash >> (64 - 27));  // ROTL64(hash, 27)
-    hash = hash * 5 + 0x52dce729;
+static ght_stripe_t* _ght_stripes_create(const ght_allocator_t* allocator, size_t count)
+{
+    ght_stripe_t* stripes = _ght_aligned_alloc(allocator, GHT_CACHE_LINE, count * sizeof(ght_stripe_t));
+    
+    if (!stripes) return NULL;
+    
+    for (size_t i = 0; i < count; i++)
+    {
+        if (thrd_success != mtx_init(&stripes[i].mutex, mtx_plain))
+        {
+            _ght_stripes_destroy(allocator, stripes, i);
+            return NULL;
+        }
+        
+        atomic_init(&stripes[i].load, 0);
+    }
+    
+    return stripes;
+}
 
-    // Finalization
-    hash ^= sizeof(uint64_t);
-    hash ^= (hash >> 33);
-    hash *= 0xff51afd7ed558ccdULL;
-    hash ^= (hash >> 33);
-    hash *= 0xc4ceb9fe1a85ec53ULL;
-    hash ^= (hash >> 33);
+static void _ght_stripes_destroy(const ght_allocator_t* allocator, ght_stripe_t* stripes, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        mtx_destroy(&stripes[i].mutex);
+    }
+    
+    _ght_aligned_free(allocator, stripes);
+}
 
-    return hash;
+static size_t _ght_thread_slot(void)
+{
+    static atomic_size_t next_slot;
+    static _Thread_local size_t slot;
+    
+    if (!slot)
+    {
+        slot = atomic_fetch_add_explicit(&next_slot, 1, memory_order_relaxed) + 1;
+    }
+    
+    return slot - 1;
 }
 
-static void _ght_delete_recursive(ght_bucket_t* bucket, ght_load_t* load, ght_deallocator_t deallocator)
+static GHT_FORCE_INLINE size_t _ght_slab_offset(void)
 {
-    if (!bucket) return;
+    return (sizeof(ght_slab_t) + GHT_CACHE_LINE - 1) & ~(size_t) (GHT_CACHE_LINE - 1);
+}
+
+static ght_slab_t* _ght_slab_map(ght_pool_t* pool)
+{
+#if defined(GHT_HAVE_MMAP)
+    if (!pool->allocator.free)
+    {
+        // Over-map and trim so the slab is aligned to its size.
+        uint8_t* map = mmap(NULL, 2 * GHT_SLAB_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        
+        if (map == MAP_FAILED) return NULL;
+        
+        uint8_t* slab = (uint8_t*) (((uintptr_t) map + GHT_SLAB_SIZE - 1) & ~(uintptr_t) (GHT_SLAB_SIZE - 1));
+        
+        if (slab > map)
+        {
+            munmap(map, slab - map);
+        }
+        
+        munmap(slab + GHT_SLAB_SIZE, map + GHT_SLAB_SIZE - slab);
+        return (ght_slab_t*) slab;
+    }
+#endif
+    ght_slab_t* slab;
     
-    if (bucket->next)
+    if (pool->allocator.aligned_alloc || !pool->allocator.free)
     {
-        _ght_delete_recursive(bucket->next, load, deallocator);
-        bucket->next = NULL;
+        slab = _ght_aligned_alloc(&pool->allocator, GHT_SLAB_SIZE, GHT_SLAB_SIZE);
+        
+        if (slab)
+        {
+            memset(slab, 0, sizeof(ght_slab_t));
+        }
+        
+        return slab;
     }
     
-    if (deallocator)
+    void* block = NULL;
+    
+    // A plain malloc knows no alignment, so slabs are carved out of blocks holding as many slabs as the pool has, up to a batch, plus one to align them.
+    if (!pool->carve_left)
     {
-        deallocator(bucket->key, bucket->data);
+        size_t count = pool->slab_count < 1 ? 1 : pool->slab_count < GHT_SLAB_BATCH ? pool->slab_count : GHT_SLAB_BATCH;
+        size_t size = (count + 1) * GHT_SLAB_SIZE;
+        
+        block = _ght_malloc(&pool->allocator, size);
+        
+        if (!block) return NULL;
+        
+        pool->carve = (uint8_t*) (((uintptr_t) block + GHT_SLAB_SIZE - 1) & ~(uintptr_t) (GHT_SLAB_SIZE - 1));
+        pool->carve_left = ((uint8_t*) block + size - pool->carve) / GHT_SLAB_SIZE;
     }
     
-    free(bucket);
-    (*load)--;
+    slab = (ght_slab_t*) pool->carve;
+    pool->carve += GHT_SLAB_SIZE;
+    pool->carve_left--;
+    
+    memset(slab, 0, sizeof(ght_slab_t));
+    slab->block = block;
+    return slab;
 }
 
-static void _ght_move_recursive(ght_bucket_t* bucket, ght_load_t* moved, ght_table_t* to_table)
+static void _ght_slab_unmap(ght_pool_t* pool, ght_slab_t* slab)
 {
-    if (!bucket) return;
+#if defined(GHT_HAVE_MMAP)
+    if (!pool->allocator.free)
+    {
+        munmap(slab, GHT_SLAB_SIZE);
+        return;
+    }
+#endif
+    // Carved slabs are released with the first slab of their block, which is linked after them.
+    if (pool->allocator.aligned_alloc || !pool->allocator.free)
+    {
+        _ght_aligned_free(&pool->allocator, slab);
+    }
+    else
+    {
+        _ght_free(&pool->allocator, slab->block);
+    }
+}
+
+static void _ght_slab_purge(ght_pool_t* pool, ght_slab_t* slab)
+{
+#if defined(GHT_HAVE_MMAP)
+    // Hand every page but the one holding the header back to the OS; they fault back in zeroed on reuse.
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
     
-    if (bucket->next)
+    // Only private anonymous slabs the pool mapped itself, memory from the caller's allocator is left to it.
+    if (!pool->allocator.free && page < GHT_SLAB_SIZE)
     {
-        _ght_move_recursive(bucket->next, moved, to_table);
+        madvise((uint8_t*) slab + page, GHT_SLAB_SIZE - page, MADV_DONTNEED);
     }
+#endif
+    slab->free = NULL;
+    slab->bump = 0;
+}
 
-    ght_index_t index = bucket->hash % to_table->width;
-    bucket->next = to_table->buckets[index];
-    to_table->buckets[index] = bucket;
-    (*moved)++;
+static void _ght_slab_link_partial(ght_pool_t* pool, ght_slab_t* slab)
+{
+    slab->prev_partial = NULL;
+    slab->next_partial = pool->partial;
+    
+    if (pool->partial)
+    {
+        pool->partial->prev_partial = slab;
+    }
+    
+    pool->partial = slab;
+    slab->partial = true;
+}
+
+static void _ght_slab_unlink_partial(ght_pool_t* pool, ght_slab_t* slab)
+{
+    if (slab->prev_partial)
+    {
+        slab->prev_partial->next_partial = slab->next_partial;
+    }
+    else
+    {
+        pool->partial = slab->next_partial;
+    }
+    
+    if (slab->next_partial)
+    {
+        slab->next_partial->prev_partial = slab->prev_partial;
+    }
+    
+    slab->next_partial = NULL;
+    slab->prev_partial = NULL;
+    slab->partial = false;
+}
+
+static ght_status_t _ght_pool_share(ght_pool_t* pool)
+{
+    pool->magazines = _ght_aligned_alloc(&pool->allocator, GHT_CACHE_LINE, GHT_MAGAZINES * sizeof(ght_magazine_t));
+    
+    if (!pool->magazines) return -1;
+    
+    for (size_t i = 0; i < GHT_MAGAZINES; i++)
+    {
+        atomic_flag_clear(&pool->magazines[i].lock);
+        pool->magazines[i].count = 0;
+    }
+    
+    atomic_store_explicit(&pool->shared, true, memory_order_release);
+    return 0;
+}
+
+static ght_pool_t* _ght_pool_create(const ght_allocator_t* allocator, size_t node_size, bool shared)
+{
+    ght_pool_t* pool = _ght_calloc(allocator, 1, sizeof(ght_pool_t));
+    
+    if (!pool) return NULL;
+    
+    if (thrd_success != mtx_init(&pool->mutex, mtx_plain))
+    {
+        _ght_free(allocator, pool);
+        return NULL;
+    }
+    
+    pool->allocator = *allocator;    
+    pool->node_size = (node_size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    pool->capacity = (GHT_SLAB_SIZE - _ght_slab_offset()) / pool->node_size;
+    pool->owner = thrd_current();
+    atomic_init(&pool->shared, false);
+    
+    if (shared && _ght_pool_share(pool))
+    {
+        _ght_pool_destroy(pool);
+        return NULL;
+    }
+    
+    return pool;
+}
+
+static void _ght_pool_destroy(ght_pool_t* pool)
+{
+    ght_slab_t* slab = pool->slabs;
+    
+    while (slab)
+    {
+        ght_slab_t* next = slab->next;
+        _ght_slab_unmap(pool, slab);
+        slab = next;
+    }
+    
+    ght_allocator_t allocator = pool->allocator;
+    
+    mtx_destroy(&pool->mutex);
+    _ght_aligned_free(&allocator, pool->magazines);
+    _ght_free(&allocator, pool);
+}
+
+static void* _ght_pool_take(ght_pool_t* pool)
+{
+    ght_slab_t* slab = pool->partial;
+    
+    if (!slab)
+    {
+        slab = _ght_slab_map(pool);
+        
+        if (!slab) return NULL;
+        
+        slab->next = pool->slabs;
+        pool->slabs = slab;
+        pool->slab_count++;
+        _ght_slab_link_partial(pool, slab);
+    }
+    
+    void* node = slab->free;
+    
+    if (node)
+    {
+        slab->free = *(void**) node;
+    }
+    else
+    {
+        node = (uint8_t*) slab + _ght_slab_offset() + slab->bump++ * pool->node_size;
+    }
+    
+    slab->live++;
+    
+    if (!slab->free && slab->bump == pool->capacity)
+    {
+        _ght_slab_unlink_partial(pool, slab);
+    }
+    
+    return node;
+}
+
+static void _ght_pool_give(ght_pool_t* pool, void* node)
+{
+    ght_slab_t* slab = (ght_slab_t*) ((uintptr_t) node & ~(uintptr_t) (GHT_SLAB_SIZE - 1));
+    
+    *(void**) node = slab->free;
+    slab->free = node;
+    slab->live--;
+    
+    if (!slab->partial)
+    {
+        _ght_slab_link_partial(pool, slab);
+    }
+    
+    // Keep the last partial slab resident so a single insert/delete cycle doesn't fault pages in and out.
+    if (!slab->live && (slab->prev_partial || slab->next_partial))
+    {
+        _ght_slab_purge(pool, slab);
+    }
+}
+
+static void* _ght_pool_alloc(ght_pool_t* pool)
+{
+    if (!atomic_load_explicit(&pool->shared, memory_order_relaxed))
+    {
+        if (thrd_equal(pool->owner, thrd_current()))
+        {
+            return _ght_pool_take(pool);
+        }
+        
+        // Callers serialize on the table mutex until the pool turns shared, so the switch itself needs no lock.
+        if (_ght_pool_share(pool))
+        {
+            return _ght_pool_take(pool);
+        }
+    }
+    
+    ght_magazine_t* magazine = &pool->magazines[_ght_thread_slot() & (GHT_MAGAZINES - 1)];
+    void* node = NULL;
+    
+    if (atomic_flag_test_and_set_explicit(&magazine->lock, memory_order_acquire))
+    {
+        // Another thread shares this magazine right now, go straight to the slabs.
+        mtx_lock(&pool->mutex);
+        node = _ght_pool_take(pool);
+        mtx_unlock(&pool->mutex);
+        return node;
+    }
+    
+    if (!magazine->count)
+    {
+        mtx_lock(&pool->mutex);
+        
+        while (magazine->count < GHT_MAGAZINE_SIZE / 2 && (node = _ght_pool_take(pool)))
+        {
+            magazine->nodes[magazine->count++] = node;
+        }
+        
+        mtx_unlock(&pool->mutex);
+    }
+    
+    node = magazine->count ? magazine->nodes[--magazine->count] : NULL;
+    
+    atomic_flag_clear_explicit(&magazine->lock, memory_order_release);
+    return node;
+}
+
+static void _ght_pool_free(ght_pool_t* pool, void* node)
+{
+    if (!atomic_load_explicit(&pool->shared, memory_order_acquire))
+    {
+        _ght_pool_give(pool, node);
+        return;
+    }
+    
+    ght_magazine_t* magazine = &pool->magazines[_ght_thread_slot() & (GHT_MAGAZINES - 1)];
+    
+    if (atomic_flag_test_and_set_explicit(&magazine->lock, memory_order_acquire))
+    {
+        mtx_lock(&pool->mutex);
+        _ght_pool_give(pool, node);
+        mtx_unlock(&pool->mutex);
+        return;
+    }
+    
+    if (magazine->count == GHT_MAGAZINE_SIZE)
+    {
+        // Flush the older half so empty slabs can still be purged under churn.
+        mtx_lock(&pool->mutex);
+        
+        for (size_t i = 0; i < GHT_MAGAZINE_SIZE / 2; i++)
+        {
+            _ght_pool_give(pool, magazine->nodes[i]);
+        }
+        
+        mtx_unlock(&pool->mutex);
+        
+        memmove(magazine->nodes, magazine->nodes + GHT_MAGAZINE_SIZE / 2, (GHT_MAGAZINE_SIZE / 2) * sizeof(void*));
+        magazine->count -= GHT_MAGAZINE_SIZE / 2;
+    }
+    
+    magazine->nodes[magazine->count++] = node;
+    
+    atomic_flag_clear_explicit(&magazine->lock, memory_order_release);
+}
+
+static bool _ght_allocator_valid(const ght_allocator_t* allocator)
+{
+    if (!allocator->malloc && !allocator->calloc && !allocator->realloc && !allocator->aligned_alloc && !allocator->free) return true;
+    
+    return allocator->free && (allocator->malloc || allocator->realloc);
+}
+
+// The functions are called through parentheses so that a malloc or free macro of the including file leaves them alone.
+static GHT_FORCE_INLINE void* _ght_malloc(const ght_allocator_t* allocator, size_t size)
+{
+    if (allocator->malloc) return (allocator->malloc)(size, allocator->context);
+    if (allocator->realloc) return (allocator->realloc)(NULL, size, allocator->context);
+    
+    return malloc(size);
+}
+
+static GHT_FORCE_INLINE void* _ght_calloc(const ght_allocator_t* allocator, size_t count, size_t size)
+{
+    if (allocator->calloc) return (allocator->calloc)(count, size, allocator->context);
+    if (!allocator->free) return calloc(count, size);
+    if (size && count > SIZE_MAX / size) return NULL;
+    
+    void* ptr = _ght_malloc(allocator, count * size);
+    
+    if (ptr)
+    {
+        memset(ptr, 0, count * size);
+    }
+    
+    return ptr;
+}
+
+static GHT_FORCE_INLINE void _ght_free(const ght_allocator_t* allocator, void* ptr)
+{
+    if (allocator->free)
+    {
+        if (ptr)
+        {
+            (allocator->free)(ptr, allocator->context);
+        }
+    }
+    else
+    {
+        free(ptr);
+    }
+}
+
+static void* _ght_aligned_alloc(const ght_allocator_t* allocator, size_t alignment, size_t size)
+{
+    if (!allocator->free) return aligned_alloc(alignment, size);
+    if (allocator->aligned_alloc) return (allocator->aligned_alloc)(alignment, size, allocator->context);
+    if (size > SIZE_MAX - alignment - sizeof(void*)) return NULL;
+    
+    // Without aligned_alloc the caller's functions know no alignment: carve the block out of a larger one and keep its address just before it.
+    uint8_t* block = _ght_malloc(allocator, size + alignment + sizeof(void*));
+    
+    if (!block) return NULL;
+    
+    uint8_t* ptr = (uint8_t*) (((uintptr_t) block + sizeof(void*) + alignment - 1) & ~(uintptr_t) (alignment - 1));
+    
+    ((void**) ptr)[-1] = block;
+    return ptr;
+}
+
+static void _ght_aligned_free(const ght_allocator_t* allocator, void* ptr)
+{
+    if (!allocator->free)
+    {
+        free(ptr);
+    }
+    else if (ptr)
+    {
+        (allocator->free)(allocator->aligned_alloc ? ptr : ((void**) ptr)[-1], allocator->context);
+    }
 }
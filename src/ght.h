@@ -27,11 +27,39 @@
 #ifndef GHT_H
 #define GHT_H
 
+// Single-header mode: GHT_IMPLEMENTATION compiles ght.c into the one translation unit that defines it,
+// GHT_STATIC into every translation unit that includes ght.h, with each function static inline.
+#if defined(GHT_STATIC) && !defined(GHT_IMPLEMENTATION)
+#define GHT_IMPLEMENTATION
+#endif
+
+#if defined(GHT_IMPLEMENTATION) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE     // Ahead of the first system header, for ght.c
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 #define	GHT_FORCE_INLINE inline __attribute__((always_inline))
 
+// GHT_STATIC also gives each translation unit its own epoch reclaimer and forwarded-bucket sentinel, so a table
+// must only be used from the translation unit that created it.
+#if defined(GHT_STATIC)
+#define GHT_API static inline
+#else
+#define GHT_API
+#endif
+
 typedef struct ght_table ght_table_t;   // Opaque type representing the hash table.
+typedef struct ght_lf_table ght_lf_table_t; // Opaque type representing the lock-free split-ordered table.
+typedef struct ght_sharded ght_sharded_t;   // Opaque type representing a table split into independent shards.
 typedef uintptr_t ght_key_t;            // Type representing a key used to access the corresponding data in the table.
 typedef uintptr_t ght_data_t;           // Type representing the data stored in the table.
 typedef int8_t ght_status_t;            // Type indicating if an error occured while executing a function.
@@ -42,7 +70,62 @@ typedef size_t ght_hash_t;              // Type representing the result of a has
 typedef double ght_load_factor_t;       // Type representing the load of table divided by its width.
 
 typedef ght_hash_t (*ght_digestor_t)(ght_key_t key);                // User-provided hashing function
+typedef ght_hash_t (*ght_keyed_digestor_t)(ght_key_t key, uint64_t seed);   // User-provided hashing function keyed by the table's seed
 typedef void (*ght_deallocator_t)(ght_key_t key, ght_data_t data);  // User-provided deallocator function for custom structures
+typedef ght_hash_t (*ght_bytes_digestor_t)(const void* key, size_t length);     // User-provided hashing function for byte keys
+typedef bool (*ght_comparator_t)(const void* a, const void* b, size_t length);  // User-provided equality of two byte keys of the same length
+typedef void* (*ght_malloc_t)(size_t size, void* context);                  // User-provided allocation function
+typedef void* (*ght_calloc_t)(size_t count, size_t size, void* context);    // User-provided zeroed allocation function
+typedef void* (*ght_realloc_t)(void* ptr, size_t size, void* context);      // User-provided reallocation function
+typedef void (*ght_free_t)(void* ptr, void* context);                       // User-provided release function
+typedef void* (*ght_aligned_alloc_t)(size_t alignment, size_t size, void* context); // User-provided aligned allocation function
+
+typedef enum ght_engine
+{
+    GHT_ENGINE_CHAINED = 0,         // Separate chaining, one allocated node per entry (default).
+    GHT_ENGINE_OPEN_ADDRESSING,     // Flat slot arrays probed 16 control bytes at a time.
+    GHT_ENGINE_ROBIN_HOOD,          // Linear probing with Robin Hood displacement and backward-shift deletion.
+    GHT_ENGINE_CUCKOO,              // 4-way bucketized cuckoo hashing, lock-free version-checked reads and bucket-pair locks.
+} ght_engine_t;
+
+typedef enum ght_resize_mode
+{
+    GHT_RESIZE_BLOCKING = 0,        // The resizing operation moves every node before returning (default).
+    GHT_RESIZE_INCREMENTAL,         // Keep both bucket arrays and migrate a few buckets on each operation.
+    GHT_RESIZE_COOPERATIVE,         // Every thread that reaches the table moves a stride of old buckets and forwards them.
+} ght_resize_mode_t;
+
+typedef enum ght_index_policy
+{
+    GHT_INDEX_MODULO = 0,           // hash % width, any width (default).
+    GHT_INDEX_POW2,                 // Widths rounded up to a power of two, index taken from the high bits of the mixed hash.
+    GHT_INDEX_FASTRANGE,            // Any width, index = (mixed hash * width) >> bits, no division.
+    GHT_INDEX_RECIPROCAL,           // Any width, exact modulo of the hash folded to 32 bits through a precomputed reciprocal.
+} ght_index_policy_t;
+
+typedef enum ght_digest
+{
+    GHT_DIGEST_AUTO = 0,            // The fastest seeded digestor the CPU supports: AES, else Murmur3 (default).
+    GHT_DIGEST_MURMUR3,             // Seeded Murmur3 finalizer, portable.
+    GHT_DIGEST_AES,                 // Two AES rounds keyed by the seed, Murmur3 without AES-NI.
+    GHT_DIGEST_CRC32C,              // Two SSE4.2 CRC32C instructions, Murmur3 without them. Linear, so unfit for untrusted keys.
+} ght_digest_t;
+
+typedef enum ght_key_mode
+{
+    GHT_KEY_INTEGER = 0,            // ght_key_t keys compared by value (default).
+    GHT_KEY_BYTES,                  // (pointer, length) keys copied into the table, used through the *_bytes functions.
+} ght_key_mode_t;
+
+typedef struct ght_allocator
+{
+    ght_malloc_t malloc;            // NULL to use realloc(NULL, size).
+    ght_calloc_t calloc;            // NULL to use malloc and clear the memory.
+    ght_realloc_t realloc;          // Only needed without malloc.
+    ght_free_t free;                // Required as soon as any other function is set.
+    ght_aligned_alloc_t aligned_alloc;  // Cache-line arrays and pool slabs, freed with free. NULL to carve them out of malloc.
+    void* context;                  // Passed to every function.
+} ght_allocator_t;
 
 typedef struct ght_cfg
 {
@@ -50,6 +133,22 @@ typedef struct ght_cfg
     ght_deallocator_t deallocator;
     ght_width_t width;
     ght_load_factor_t auto_resize;
+    ght_engine_t engine;
+    bool node_pool;                 // Chained engine: carve nodes out of slabs owned by the table instead of calloc.
+    size_t lock_stripes;            // Chained and cuckoo engines: number of bucket locks (rounded up to a power of two), 0 for a single table lock or the cuckoo default.
+    bool read_mostly;               // Chained engine: ght_search takes no lock, writers copy on update and reclaim after a grace period.
+    ght_resize_mode_t resize_mode;  // Chained engine: how nodes move to a new bucket array.
+    ght_index_policy_t index_policy;// Chained engine: how a hash is reduced to a bucket index.
+    ght_key_mode_t key_mode;        // Chained engine: integer or byte keys.
+    size_t key_inline;              // Byte keys: keys up to this length are stored inside the node instead of a separate allocation.
+    ght_bytes_digestor_t bytes_digestor;    // Byte keys: hashing function, the built-in seeded Murmur64A when NULL.
+    ght_comparator_t comparator;    // Byte keys: equality function, memcmp when NULL.
+    ght_load_factor_t auto_shrink;  // Chained, open addressing and Robin Hood engines: load factor below which ght_delete halves the width, 0.0 to disable. Must be under half of auto_resize.
+    ght_keyed_digestor_t keyed_digestor;    // Used instead of digestor and given the table's seed.
+    uint64_t seed;                  // Seed of the keyed and built-in digestors, 0 to draw a random one at creation.
+    size_t reseed_chain;            // Chained engine with a seeded digestor: an insert that walks a chain this many times the average re-seeds the table, 0 to disable.
+    ght_digest_t digest;            // Built-in digestor for integer keys, used when digestor and keyed_digestor are NULL.
+    ght_allocator_t allocator;      // Memory of the table, its arrays and nodes, the C library's when every function is NULL.
 } ght_cfg_t;
 
 // Conversion functions for various types to ght_data_t
@@ -61,8 +160,8 @@ static GHT_FORCE_INLINE ght_data_t _ght_uint8_to_data(uint8_t data) {return (ght
 static GHT_FORCE_INLINE ght_data_t _ght_uint16_to_data(uint16_t data) {return (ght_data_t) data;}
 static GHT_FORCE_INLINE ght_data_t _ght_uint32_to_data(uint32_t data) {return (ght_data_t) data;}
 static GHT_FORCE_INLINE ght_data_t _ght_uint64_to_data(uint64_t data) {return (ght_data_t) data;}
-static GHT_FORCE_INLINE ght_data_t _ght_float_to_data(float data) {return *(ght_data_t*) &data;}
-static GHT_FORCE_INLINE ght_data_t _ght_double_to_data(double data) {return *(ght_data_t*) &data;}
+static GHT_FORCE_INLINE ght_data_t _ght_float_to_data(float data) {ght_data_t bits = 0; memcpy(&bits, &data, sizeof(data)); return bits;}
+static GHT_FORCE_INLINE ght_data_t _ght_double_to_data(double data) {ght_data_t bits = 0; memcpy(&bits, &data, sizeof(data) < sizeof(bits) ? sizeof(data) : sizeof(bits)); return bits;}
 //static GHT_FORCE_INLINE ght_data_t _ght_longdouble_to_data(long double data) {return *(ght_data_t*) &data;} // Long double can be larger than ght_data_t
 static GHT_FORCE_INLINE ght_data_t _ght_voidptr_to_data(void* data) {return (ght_data_t) data;}
 
@@ -82,8 +181,12 @@ static GHT_FORCE_INLINE ght_data_t _ght_voidptr_to_data(void* data) {return (ght
 
 #define GHT_KEY(key) GHT_DATA(key)
 
-#define GHT_FLOAT(data)         (*(float*) &data)
-#define GHT_DOUBLE(data)        (*(double*) &data)
+// Conversion functions from ght_data_t back to floating point, the bits are copied so no pointer is type-punned
+static GHT_FORCE_INLINE float _ght_data_to_float(ght_data_t data) {float value; memcpy(&value, &data, sizeof(value)); return value;}
+static GHT_FORCE_INLINE double _ght_data_to_double(ght_data_t data) {double value = 0.0; memcpy(&value, &data, sizeof(value) < sizeof(data) ? sizeof(value) : sizeof(data)); return value;}
+
+#define GHT_FLOAT(data)         _ght_data_to_float(data)
+#define GHT_DOUBLE(data)        _ght_data_to_double(data)
 
 /**
  * @brief Creates a new hash table.
@@ -91,7 +194,22 @@ static GHT_FORCE_INLINE ght_data_t _ght_voidptr_to_data(void* data) {return (ght
  * @param cfg The table configuration.
  * @return Pointer to the created ght_table_t or NULL on failure.
  */
-ght_table_t* ght_create(ght_cfg_t* cfg);
+GHT_API ght_table_t* ght_create(ght_cfg_t* cfg);
+
+/**
+ * @brief Creates a new hash table already holding count entries.
+ * 
+ * The table is sized for count entries before the first one goes in. Chained tables take their
+ * nodes from the node pool when cfg is NULL, and follow cfg->node_pool otherwise. A key that
+ * appears more than once keeps its last data.
+ * 
+ * @param cfg The table configuration, integer keys only.
+ * @param keys Array of count keys.
+ * @param data Array of count data, data[i] belongs to keys[i].
+ * @param count Number of entries.
+ * @return Pointer to the created ght_table_t or NULL on failure.
+ */
+GHT_API ght_table_t* ght_create_from_arrays(ght_cfg_t* cfg, const ght_key_t* keys, const ght_data_t* data, size_t count);
 
 /**
  * @brief Destroys the entire table and frees all allocated memory.
@@ -99,7 +217,7 @@ ght_table_t* ght_create(ght_cfg_t* cfg);
  * @param table The table to destroy.
  * @return 0 on success, -1 on failure.
  */
-ght_status_t ght_destroy(ght_table_t* table);
+GHT_API ght_status_t ght_destroy(ght_table_t* table);
 
 /**
  * @brief Inserts data in the table and associates it to a key.
@@ -109,7 +227,29 @@ ght_status_t ght_destroy(ght_table_t* table);
  * @param data The data to insert.
  * @return 0 on success, -1 on failure.
  */
-ght_status_t ght_insert(ght_table_t* table, ght_key_t key, ght_data_t data);
+GHT_API ght_status_t ght_insert(ght_table_t* table, ght_key_t key, ght_data_t data);
+
+/**
+ * @brief Inserts data in the table with a key hashed by the caller.
+ * 
+ * @param table The table to insert the data into.
+ * @param hash ght_hash of key, from this table or a table with the same digestor and the same non-zero cfg.seed.
+ * @param key The key to associate the data with.
+ * @param data The data to insert.
+ * @return 0 on success, -1 on failure.
+ */
+GHT_API ght_status_t ght_insert_hashed(ght_table_t* table, ght_hash_t hash, ght_key_t key, ght_data_t data);
+
+/**
+ * @brief Inserts data in a byte-key table and associates it to a copy of the key.
+ * 
+ * @param table The table to insert the data into.
+ * @param key The key bytes.
+ * @param length The length of the key in bytes.
+ * @param data The data to insert.
+ * @return 0 on success, -1 on failure or if the table doesn't use byte keys.
+ */
+GHT_API ght_status_t ght_insert_bytes(ght_table_t* table, const void* key, size_t length, ght_data_t data);
 
 /**
  * @brief Searches and returns the data associated to a key.
@@ -118,7 +258,43 @@ ght_status_t ght_insert(ght_table_t* table, ght_key_t key, ght_data_t data);
  * @param key The key associated to the data.
  * @return The data or 0 if table is empty or data isn't found.
  */
-ght_data_t ght_search(ght_table_t* table, ght_key_t key);
+GHT_API ght_data_t ght_search(ght_table_t* table, ght_key_t key);
+
+/**
+ * @brief Searches the data associated to a key hashed by the caller.
+ * 
+ * @param table The table to search.
+ * @param hash ght_hash of key, from this table or a table with the same digestor and the same non-zero cfg.seed.
+ * @param key The key associated to the data.
+ * @return The data or 0 if table is empty or data isn't found.
+ */
+GHT_API ght_data_t ght_search_hashed(ght_table_t* table, ght_hash_t hash, ght_key_t key);
+
+/**
+ * @brief Searches a byte-key table and returns the data associated to a key.
+ * 
+ * @param table The table to search.
+ * @param key The key bytes.
+ * @param length The length of the key in bytes.
+ * @return The data or 0 if table is empty, data isn't found or the table doesn't use byte keys.
+ */
+GHT_API ght_data_t ght_search_bytes(ght_table_t* table, const void* key, size_t length);
+
+/**
+ * @brief Searches a batch of keys at once.
+ * 
+ * The keys are hashed and their buckets prefetched in groups before any chain is walked,
+ * so the cache misses of independent keys overlap. Found entries are not moved to the
+ * front of their chain.
+ * 
+ * @param table The table to search.
+ * @param keys The keys to search for.
+ * @param data Receives the data associated to each key, or 0 when the key isn't found.
+ * @param found Receives whether each key was found, may be NULL.
+ * @param count The number of keys.
+ * @return The number of keys found.
+ */
+GHT_API size_t ght_search_batch(ght_table_t* table, const ght_key_t* keys, ght_data_t* data, bool* found, size_t count);
 
 /**
  * @brief Deletes the data associated to a key.
@@ -127,7 +303,51 @@ ght_data_t ght_search(ght_table_t* table, ght_key_t key);
  * @param key The key associated to the data.
  * @return 0 on success, -1 on failure.
  */
-ght_status_t ght_delete(ght_table_t* table, ght_key_t key);
+GHT_API ght_status_t ght_delete(ght_table_t* table, ght_key_t key);
+
+/**
+ * @brief Deletes the data associated to a key hashed by the caller.
+ * 
+ * @param table The table to delete the data from.
+ * @param hash ght_hash of key, from this table or a table with the same digestor and the same non-zero cfg.seed.
+ * @param key The key associated to the data.
+ * @return 0 on success, -1 on failure.
+ */
+GHT_API ght_status_t ght_delete_hashed(ght_table_t* table, ght_hash_t hash, ght_key_t key);
+
+/**
+ * @brief Hashes a key with the digestor of the table.
+ * 
+ * A table created with seed 0 draws its own random seed, so its hashes only fit itself.
+ * A re-seed (reseed_chain) invalidates earlier hashes, the _hashed operations of such a
+ * table check the hash against the key under the lock and recompute it when it is stale.
+ * 
+ * @param table The table whose digestor is used, integer keys only.
+ * @param key The key to hash.
+ * @return The hash of the key, or 0 for a byte-key table.
+ */
+GHT_API ght_hash_t ght_hash(ght_table_t* table, ght_key_t key);
+
+/**
+ * @brief Keyed digestor for integer keys, two folded 128-bit multiplies as in wyhash.
+ * 
+ * Meant for ght_cfg_t.keyed_digestor, it is faster than the built-in seeded Murmur3.
+ * 
+ * @param key The key to hash.
+ * @param seed The seed of the table.
+ * @return The hash of the key.
+ */
+GHT_API ght_hash_t ght_digestor_mum(ght_key_t key, uint64_t seed);
+
+/**
+ * @brief Deletes the data associated to a key in a byte-key table.
+ * 
+ * @param table The table to delete the data from.
+ * @param key The key bytes.
+ * @param length The length of the key in bytes.
+ * @return 0 on success, -1 on failure or if the table doesn't use byte keys.
+ */
+GHT_API ght_status_t ght_delete_bytes(ght_table_t* table, const void* key, size_t length);
 
 /**
  * @brief Returns the number of elements in the table.
@@ -135,7 +355,7 @@ ght_status_t ght_delete(ght_table_t* table, ght_key_t key);
  * @param table The table to get the load of.
  * @return The number of elements in the table, or 0 if the table is NULL.
  */
-ght_load_t ght_load(ght_table_t* table);
+GHT_API ght_load_t ght_load(ght_table_t* table);
 
 /**
  * @brief Returns the width of the table.
@@ -143,7 +363,7 @@ ght_load_t ght_load(ght_table_t* table);
  * @param table The table to get the width of.
  * @return The width of the table, or 0 if the table is NULL.
  */
-ght_width_t ght_width(ght_table_t* table);
+GHT_API ght_width_t ght_width(ght_table_t* table);
 
 /**
  * @brief Returns the load factor of the table.
@@ -151,7 +371,7 @@ ght_width_t ght_width(ght_table_t* table);
  * @param table The table to get the load factor from.
  * @return The load factor of the table.
  */
-ght_load_factor_t ght_load_factor(ght_table_t* table);
+GHT_API ght_load_factor_t ght_load_factor(ght_table_t* table);
 
 /**
  * @brief Resizes the table.
@@ -160,6 +380,458 @@ ght_load_factor_t ght_load_factor(ght_table_t* table);
  * @param width The new width of the table.
  * @return 0 on success, -1 on failure.
  */
-ght_status_t ght_resize(ght_table_t* table, ght_width_t width);
+GHT_API ght_status_t ght_resize(ght_table_t* table, ght_width_t width);
+
+/**
+ * @brief Grows the table so that count entries fit without any further resize.
+ * 
+ * @param table The table to grow.
+ * @param count The number of entries the table must hold.
+ * @return 0 on success, -1 on failure or if no width fits count entries.
+ */
+GHT_API ght_status_t ght_reserve(ght_table_t* table, ght_load_t count);
+
+/**
+ * @brief Creates a lock-free split-ordered table.
+ * 
+ * Every entry lives in a single linked list sorted by bit-reversed hash, and each bucket
+ * is a sentinel node pointing into that list. Insertions, searches and deletions never
+ * take a lock. Growing only doubles the bucket count, new buckets are split off their
+ * parent the first time they are used. Only the digestor, keyed_digestor, digest, seed,
+ * deallocator, width, auto_resize and allocator fields of the configuration are used.
+ * 
+ * @param cfg The table configuration, byte keys are not supported.
+ * @return Pointer to the created ght_lf_table_t or NULL on failure.
+ */
+GHT_API ght_lf_table_t* ght_lf_create(ght_cfg_t* cfg);
+
+/**
+ * @brief Destroys a lock-free table, no other thread may still use it.
+ * 
+ * @param table The table to destroy.
+ * @return 0 on success, -1 on failure.
+ */
+GHT_API ght_status_t ght_lf_destroy(ght_lf_table_t* table);
+
+/**
+ * @brief Inserts data in a lock-free table, or replaces the data already associated to the key.
+ * 
+ * @param table The table to insert the data into.
+ * @param key The key to associate the data with.
+ * @param data The data to insert.
+ * @return 0 on success, -1 on failure.
+ */
+GHT_API ght_status_t ght_lf_insert(ght_lf_table_t* table, ght_key_t key, ght_data_t data);
+
+/**
+ * @brief Searches a lock-free table and returns the data associated to a key.
+ * 
+ * @param table The table to search.
+ * @param key The key associated to the data.
+ * @return The data or 0 if table is empty or data isn't found.
+ */
+GHT_API ght_data_t ght_lf_search(ght_lf_table_t* table, ght_key_t key);
+
+/**
+ * @brief Deletes the data associated to a key in a lock-free table.
+ * 
+ * @param table The table to delete the data from.
+ * @param key The key associated to the data.
+ * @return 0 on success, -1 on failure.
+ */
+GHT_API ght_status_t ght_lf_delete(ght_lf_table_t* table, ght_key_t key);
+
+/**
+ * @brief Returns the number of elements in a lock-free table.
+ * 
+ * @param table The table to get the load of.
+ * @return The number of elements in the table, or 0 if the table is NULL.
+ */
+GHT_API ght_load_t ght_lf_load(ght_lf_table_t* table);
+
+/**
+ * @brief Returns the number of buckets of a lock-free table.
+ * 
+ * @param table The table to get the width of.
+ * @return The width of the table, or 0 if the table is NULL.
+ */
+GHT_API ght_width_t ght_lf_width(ght_lf_table_t* table);
+
+/**
+ * @brief Returns the load factor of a lock-free table.
+ * 
+ * @param table The table to get the load factor from.
+ * @return The load factor of the table.
+ */
+GHT_API ght_load_factor_t ght_lf_load_factor(ght_lf_table_t* table);
+
+/**
+ * @brief Grows a lock-free table to at least a number of buckets.
+ * 
+ * Only the bucket count is raised, the buckets are initialized by the operations that reach them.
+ * 
+ * @param table The table to grow.
+ * @param width The new width of the table, rounded up to a power of two.
+ * @return 0 on success, -1 on failure or if the width is below the current one.
+ */
+GHT_API ght_status_t ght_lf_resize(ght_lf_table_t* table, ght_width_t width);
+
+/**
+ * @brief Creates a table split into independent shards.
+ * 
+ * The top bits of each key's hash select one of the shards, each a full ght_table_t with its
+ * own lock, load and auto_resize created from the same configuration. A shard grows on its
+ * own, so each resize only moves the entries of that shard.
+ * 
+ * @param cfg The configuration of every shard, its width is the total split between them. Byte keys are not supported.
+ * @param shards The number of shards, rounded up to a power of two.
+ * @return Pointer to the created ght_sharded_t or NULL on failure.
+ */
+GHT_API ght_sharded_t* ght_sharded_create(ght_cfg_t* cfg, size_t shards);
+
+/**
+ * @brief Destroys a sharded table and every shard.
+ * 
+ * @param table The table to destroy.
+ * @return 0 on success, -1 on failure.
+ */
+GHT_API ght_status_t ght_sharded_destroy(ght_sharded_t* table);
+
+/**
+ * @brief Inserts data in the shard of a key and associates it to the key.
+ * 
+ * @param table The table to insert the data into.
+ * @param key The key to associate the data with.
+ * @param data The data to insert.
+ * @return 0 on success, -1 on failure.
+ */
+GHT_API ght_status_t ght_sharded_insert(ght_sharded_t* table, ght_key_t key, ght_data_t data);
+
+/**
+ * @brief Searches the shard of a key and returns the data associated to it.
+ * 
+ * @param table The table to search.
+ * @param key The key associated to the data.
+ * @return The data or 0 if table is empty or data isn't found.
+ */
+GHT_API ght_data_t ght_sharded_search(ght_sharded_t* table, ght_key_t key);
+
+/**
+ * @brief Deletes the data associated to a key from its shard.
+ * 
+ * @param table The table to delete the data from.
+ * @param key The key associated to the data.
+ * @return 0 on success, -1 on failure.
+ */
+GHT_API ght_status_t ght_sharded_delete(ght_sharded_t* table, ght_key_t key);
+
+/**
+ * @brief Returns the number of elements in all shards.
+ * 
+ * @param table The table to get the load of.
+ * @return The number of elements in the table, or 0 if the table is NULL.
+ */
+GHT_API ght_load_t ght_sharded_load(ght_sharded_t* table);
+
+/**
+ * @brief Returns the total width of all shards.
+ * 
+ * @param table The table to get the width of.
+ * @return The width of the table, or 0 if the table is NULL.
+ */
+GHT_API ght_width_t ght_sharded_width(ght_sharded_t* table);
+
+/**
+ * @brief Returns the load factor of a sharded table.
+ * 
+ * @param table The table to get the load factor from.
+ * @return The load factor of the table.
+ */
+GHT_API ght_load_factor_t ght_sharded_load_factor(ght_sharded_t* table);
+
+/**
+ * @brief Resizes every shard to its share of a width, one shard at a time.
+ * 
+ * @param table The table to resize.
+ * @param width The new total width of the table.
+ * @return 0 on success, -1 if any shard failed to resize.
+ */
+GHT_API ght_status_t ght_sharded_resize(ght_sharded_t* table, ght_width_t width);
+
+/**
+ * @brief Registers the calling thread with the epoch-based reclaimer ahead of its first operation.
+ * 
+ * Lock-free readers (read_mostly tables, the cuckoo engine and ght_lf_* tables) announce
+ * themselves in a per-thread record and free retired memory from per-thread limbo lists.
+ * Threads are registered automatically on first use, calling this only moves the
+ * allocation of the record out of the first operation. When no record can be allocated,
+ * those operations fail instead: writes return -1, lookups return 0 and find nothing.
+ * 
+ * @return 0 on success, -1 on failure.
+ */
+GHT_API ght_status_t ght_thread_register(void);
+
+/**
+ * @brief Releases the calling thread's reclaimer record so another thread can reuse it.
+ * 
+ * Waits for a grace period and frees everything the thread retired. This runs automatically
+ * when a thread exits and must not be called from inside a table operation or a deallocator.
+ */
+GHT_API void ght_thread_unregister(void);
+
+/*
+ * Type-specialized tables
+ * 
+ * GHT_DEFINE_TABLE(name, key_type, value_type, hash_fn, eq_fn) generates a table type name_t
+ * and its functions name_create, name_destroy, name_insert, name_search, name_delete,
+ * name_resize, name_load and name_width. Keys and values are stored with their own types, and
+ * hash_fn(key) and eq_fn(a, b), functions or macros, are expanded inside every function, so
+ * nothing goes through a function pointer or ght_data_t. The tables use open addressing with
+ * linear probing over power-of-two slot arrays, grow past 3/4 full and are not thread-safe.
+ * 
+ * GHT_TABLE_TYPE and GHT_TABLE_PROTOTYPES declare a table in a header, GHT_TABLE_IMPL
+ * defines its functions with the given linkage in one translation unit.
+ */
+
+#define GHT_TYPED_EMPTY         0
+#define GHT_TYPED_FULL          1
+#define GHT_TYPED_DELETED       2
+#define GHT_TYPED_MIN_BITS      3
+
+// Murmur3 finalizer, a hash_fn for integer keys.
+static GHT_FORCE_INLINE ght_hash_t ght_hash_int(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    
+    return (ght_hash_t) key;
+}
+
+#define GHT_EQUAL(a, b)         ((a) == (b))
+
+// The top bits of the hash times 2^64 / phi, so that a weak hash_fn still spreads over the slots.
+#define GHT_TYPED_SLOT(hash, bits)  ((size_t) (((uint64_t) (hash) * 0x9e3779b97f4a7c15ULL) >> (64 - (bits))))
+
+#define GHT_TABLE_TYPE(name, key_type, value_type)                                                          \
+    typedef struct name                                                                                     \
+    {                                                                                                       \
+        ght_width_t width;                                                                                  \
+        ght_load_t load;                                                                                    \
+        ght_load_t used;        /* Full and deleted slots */                                                \
+        unsigned bits;                                                                                      \
+        uint8_t* ctrl;                                                                                      \
+        key_type* keys;                                                                                     \
+        value_type* values;                                                                                 \
+    } name##_t;
+
+#define GHT_TABLE_PROTOTYPES(name, key_type, value_type)                                                    \
+    name##_t* name##_create(ght_width_t width);                                                             \
+    ght_status_t name##_destroy(name##_t* table);                                                           \
+    ght_status_t name##_insert(name##_t* table, key_type key, value_type value);                            \
+    value_type* name##_search(name##_t* table, key_type key);                                               \
+    ght_status_t name##_delete(name##_t* table, key_type key);                                              \
+    ght_status_t name##_resize(name##_t* table, ght_width_t width);                                         \
+    ght_load_t name##_load(name##_t* table);                                                                \
+    ght_width_t name##_width(name##_t* table);
+
+#define GHT_TABLE_IMPL(scope, name, key_type, value_type, hash_fn, eq_fn)                                   \
+    scope ght_status_t name##_resize(name##_t* table, ght_width_t width)                                    \
+    {                                                                                                       \
+        if (!table) return -1;                                                                              \
+                                                                                                            \
+        unsigned bits = GHT_TYPED_MIN_BITS;                                                                 \
+                                                                                                            \
+        while (((ght_width_t) 1 << bits) < width && bits < sizeof(ght_width_t) * 8 - 2) bits++;             \
+                                                                                                            \
+        width = (ght_width_t) 1 << bits;                                                                    \
+                                                                                                            \
+        if (table->load > width / 4 * 3) return -1;                                                         \
+                                                                                                            \
+        uint8_t* ctrl = (uint8_t*) calloc(width, sizeof(uint8_t));                                          \
+        key_type* keys = (key_type*) malloc(width * sizeof(key_type));                                      \
+        value_type* values = (value_type*) malloc(width * sizeof(value_type));                              \
+                                                                                                            \
+        if (!ctrl || !keys || !values)                                                                      \
+        {                                                                                                   \
+            free(ctrl);                                                                                     \
+            free(keys);                                                                                     \
+            free(values);                                                                                   \
+            return -1;                                                                                      \
+        }                                                                                                   \
+                                                                                                            \
+        for (ght_width_t i = 0; i < table->width; i++)                                                      \
+        {                                                                                                   \
+            if (table->ctrl[i] != GHT_TYPED_FULL) continue;                                                 \
+                                                                                                            \
+            size_t slot = GHT_TYPED_SLOT(hash_fn(table->keys[i]), bits);                                    \
+                                                                                                            \
+            while (ctrl[slot] != GHT_TYPED_EMPTY) slot = (slot + 1) & (width - 1);                          \
+                                                                                                            \
+            ctrl[slot] = GHT_TYPED_FULL;                                                                    \
+            keys[slot] = table->keys[i];                                                                    \
+            values[slot] = table->values[i];                                                                \
+        }                                                                                                   \
+                                                                                                            \
+        free(table->ctrl);                                                                                  \
+        free(table->keys);                                                                                  \
+        free(table->values);                                                                                \
+                                                                                                            \
+        table->ctrl = ctrl;                                                                                 \
+        table->keys = keys;                                                                                 \
+        table->values = values;                                                                             \
+        table->width = width;                                                                               \
+        table->bits = bits;                                                                                 \
+        table->used = table->load;                                                                          \
+                                                                                                            \
+        return 0;                                                                                           \
+    }                                                                                                       \
+                                                                                                            \
+    scope name##_t* name##_create(ght_width_t width)                                                        \
+    {                                                                                                       \
+        name##_t* table = (name##_t*) calloc(1, sizeof(name##_t));                                          \
+                                                                                                            \
+        if (!table) return NULL;                                                                            \
+                                                                                                            \
+        if (name##_resize(table, width))                                                                    \
+        {                                                                                                   \
+            free(table);                                                                                    \
+            return NULL;                                                                                    \
+        }                                                                                                   \
+                                                                                                            \
+        return table;                                                                                       \
+    }                                                                                                       \
+                                                                                                            \
+    scope ght_status_t name##_destroy(name##_t* table)                                                      \
+    {                                                                                                       \
+        if (!table) return -1;                                                                              \
+                                                                                                            \
+        free(table->ctrl);                                                                                  \
+        free(table->keys);                                                                                  \
+        free(table->values);                                                                                \
+        free(table);                                                                                        \
+                                                                                                            \
+        return 0;                                                                                           \
+    }                                                                                                       \
+                                                                                                            \
+    scope ght_status_t name##_insert(name##_t* table, key_type key, value_type value)                       \
+    {                                                                                                       \
+        if (!table) return -1;                                                                              \
+                                                                                                            \
+        /* Deleted slots count as used, a table full of them is rebuilt at the same width. */               \
+        if (table->used + 1 > table->width / 4 * 3)                                                         \
+        {                                                                                                   \
+            ght_width_t width = table->load + 1 > table->width / 2 ? table->width * 2 : table->width;       \
+                                                                                                            \
+            if (name##_resize(table, width)) return -1;                                                     \
+        }                                                                                                   \
+                                                                                                            \
+        ght_width_t mask = table->width - 1;                                                                \
+        size_t slot = GHT_TYPED_SLOT(hash_fn(key), table->bits);                                            \
+        size_t free_slot = SIZE_MAX;                                                                        \
+                                                                                                            \
+        while (table->ctrl[slot] != GHT_TYPED_EMPTY)                                                        \
+        {                                                                                                   \
+            if (table->ctrl[slot] == GHT_TYPED_FULL && eq_fn(table->keys[slot], key))                       \
+            {                                                                                               \
+                table->values[slot] = value;                                                                \
+                return 0;                                                                                   \
+            }                                                                                               \
+                                                                                                            \
+            if (table->ctrl[slot] == GHT_TYPED_DELETED && free_slot == SIZE_MAX) free_slot = slot;          \
+                                                                                                            \
+            slot = (slot + 1) & mask;                                                                       \
+        }                                                                                                   \
+                                                                                                            \
+        if (free_slot == SIZE_MAX)                                                                          \
+        {                                                                                                   \
+            free_slot = slot;                                                                               \
+            table->used++;                                                                                  \
+        }                                                                                                   \
+                                                                                                            \
+        table->ctrl[free_slot] = GHT_TYPED_FULL;                                                            \
+        table->keys[free_slot] = key;                                                                       \
+        table->values[free_slot] = value;                                                                   \
+        table->load++;                                                                                      \
+                                                                                                            \
+        return 0;                                                                                           \
+    }                                                                                                       \
+                                                                                                            \
+    scope value_type* name##_search(name##_t* table, key_type key)                                          \
+    {                                                                                                       \
+        if (!table || !table->load) return NULL;                                                            \
+                                                                                                            \
+        ght_width_t mask = table->width - 1;                                                                \
+        size_t slot = GHT_TYPED_SLOT(hash_fn(key), table->bits);                                            \
+                                                                                                            \
+        while (table->ctrl[slot] != GHT_TYPED_EMPTY)                                                        \
+        {                                                                                                   \
+            if (table->ctrl[slot] == GHT_TYPED_FULL && eq_fn(table->keys[slot], key))                       \
+            {                                                                                               \
+                return &table->values[slot];                                                                \
+            }                                                                                               \
+                                                                                                            \
+            slot = (slot + 1) & mask;                                                                       \
+        }                                                                                                   \
+                                                                                                            \
+        return NULL;                                                                                        \
+    }                                                                                                       \
+                                                                                                            \
+    scope ght_status_t name##_delete(name##_t* table, key_type key)                                         \
+    {                                                                                                       \
+        if (!table || !table->load) return -1;                                                              \
+                                                                                                            \
+        ght_width_t mask = table->width - 1;                                                                \
+        size_t slot = GHT_TYPED_SLOT(hash_fn(key), table->bits);                                            \
+                                                                                                            \
+        while (table->ctrl[slot] != GHT_TYPED_EMPTY)                                                        \
+        {                                                                                                   \
+            if (table->ctrl[slot] == GHT_TYPED_FULL && eq_fn(table->keys[slot], key))                       \
+            {                                                                                               \
+                /* A slot before an empty one ends every probe through it and can be emptied. */            \
+                if (table->ctrl[(slot + 1) & mask] == GHT_TYPED_EMPTY)                                      \
+                {                                                                                           \
+                    table->ctrl[slot] = GHT_TYPED_EMPTY;                                                    \
+                    table->used--;                                                                          \
+                }                                                                                           \
+                else                                                                                        \
+                {                                                                                           \
+                    table->ctrl[slot] = GHT_TYPED_DELETED;                                                  \
+                }                                                                                           \
+                                                                                                            \
+                table->load--;                                                                              \
+                return 0;                                                                                   \
+            }                                                                                               \
+                                                                                                            \
+            slot = (slot + 1) & mask;                                                                       \
+        }                                                                                                   \
+                                                                                                            \
+        return -1;                                                                                          \
+    }                                                                                                       \
+                                                                                                            \
+    scope ght_load_t name##_load(name##_t* table)                                                           \
+    {                                                                                                       \
+        return table ? table->load : 0;                                                                     \
+    }                                                                                                       \
+                                                                                                            \
+    scope ght_width_t name##_width(name##_t* table)                                                         \
+    {                                                                                                       \
+        return table ? table->width : 0;                                                                    \
+    }
+
+#define GHT_DEFINE_TABLE(name, key_type, value_type, hash_fn, eq_fn)                                        \
+    GHT_TABLE_TYPE(name, key_type, value_type)                                                              \
+    GHT_TABLE_IMPL(static inline, name, key_type, value_type, hash_fn, eq_fn)
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* GHT_H */
+
+#if defined(GHT_IMPLEMENTATION) && !defined(GHT_IMPLEMENTATION_INCLUDED)
+#define GHT_IMPLEMENTATION_INCLUDED
+#include "ght.c"
+#endif
@@ -0,0 +1,450 @@
+/*
+ * ght.hpp - Generic Hash Table C++ interface
+ *
+ * Copyright (c) 2024 Laurent Mailloux-Bourassa
+ *
+ * This file is part of the Generic Hash Table (GHT) library.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GHT_HPP
+#define GHT_HPP
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ght.h"
+
+namespace ght
+{
+
+// std::hash, made transparent for strings so that a std::string_view or a literal finds std::string keys.
+template <class K>
+struct hash : std::hash<K> {};
+
+template <class CharT, class Traits, class StringAlloc>
+struct hash<std::basic_string<CharT, Traits, StringAlloc>>
+{
+    using is_transparent = void;
+
+    std::size_t operator()(std::basic_string_view<CharT, Traits> key) const noexcept
+    {
+        return std::hash<std::basic_string_view<CharT, Traits>>{}(key);
+    }
+};
+
+/**
+ * @brief Move-only, typed hash table over a ght_table_t.
+ *
+ * Each entry is a node holding a std::pair<const K, V>, allocated through Alloc. The C table maps
+ * the Hash of a key to the first node with that hash, nodes whose keys share a hash are chained
+ * behind it and compared with Eq. The nodes are also linked in a list for iteration.
+ * Iterators and references stay valid until their entry is erased.
+ *
+ * Lookups through a Hash and Eq that both define is_transparent accept any key type they take,
+ * such as std::string_view for std::string keys. The table is not thread-safe.
+ */
+template <class K, class V, class Hash = ght::hash<K>, class Eq = std::equal_to<>,
+          class Alloc = std::allocator<std::pair<const K, V>>>
+class table
+{
+    struct node
+    {
+        std::pair<const K, V> value;
+        std::size_t hash;
+        node* chain;        // Next node whose key has the same hash.
+        node* prev;
+        node* next;
+    };
+
+    using node_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+    using node_traits = std::allocator_traits<node_allocator>;
+
+    template <class T, class = void>
+    struct is_transparent : std::false_type {};
+
+    template <class T>
+    struct is_transparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+
+    template <class KeyLike>
+    using transparent_key = std::enable_if_t<is_transparent<Hash>::value && is_transparent<Eq>::value, KeyLike>;
+
+    template <bool Const>
+    class basic_iterator
+    {
+        friend class table;
+
+        node* current = nullptr;
+
+        explicit basic_iterator(node* position) noexcept : current(position) {}
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const K, V>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+        basic_iterator() noexcept = default;
+
+        template <bool WasConst, class = std::enable_if_t<Const && !WasConst>>
+        basic_iterator(const basic_iterator<WasConst>& other) noexcept : current(other.current) {}
+
+        reference operator*() const noexcept {return current->value;}
+        pointer operator->() const noexcept {return &current->value;}
+
+        basic_iterator& operator++() noexcept
+        {
+            current = current->next;
+            return *this;
+        }
+
+        basic_iterator operator++(int) noexcept
+        {
+            basic_iterator copy = *this;
+            current = current->next;
+            return copy;
+        }
+
+        friend bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept {return a.current == b.current;}
+        friend bool operator!=(const basic_iterator& a, const basic_iterator& b) noexcept {return a.current != b.current;}
+    };
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using key_equal = Eq;
+    using allocator_type = Alloc;
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    table() : table(nullptr, Hash(), Eq(), Alloc()) {}
+
+    explicit table(const Alloc& allocator) : table(nullptr, Hash(), Eq(), allocator) {}
+
+    /**
+     * @brief Creates the table from a configuration of the C table.
+     *
+     * The configuration is used as is, except that keys are integers and no deallocator is called.
+     *
+     * @throws std::bad_alloc if ght_create fails.
+     */
+    explicit table(const ght_cfg_t& cfg, const Hash& hash_fn = Hash(), const Eq& comparator = Eq(), const Alloc& allocator = Alloc())
+        : table(&cfg, hash_fn, comparator, allocator) {}
+
+    table(const table&) = delete;
+    table& operator=(const table&) = delete;
+
+    // The allocator moves along with the entries, a moved-from table can only be destroyed or assigned to.
+    table(table&& other) noexcept
+        : core(std::exchange(other.core, nullptr)), head(std::exchange(other.head, nullptr)), entries(std::exchange(other.entries, 0)),
+          hash(std::move(other.hash)), equal(std::move(other.equal)), alloc(std::move(other.alloc)) {}
+
+    table& operator=(table&& other) noexcept
+    {
+        table(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~table()
+    {
+        destroy_nodes();
+        ght_destroy(core);
+    }
+
+    iterator begin() noexcept {return iterator(head);}
+    iterator end() noexcept {return iterator();}
+    const_iterator begin() const noexcept {return const_iterator(head);}
+    const_iterator end() const noexcept {return const_iterator();}
+    const_iterator cbegin() const noexcept {return const_iterator(head);}
+    const_iterator cend() const noexcept {return const_iterator();}
+
+    bool empty() const noexcept {return !entries;}
+    size_type size() const noexcept {return entries;}
+
+    iterator find(const K& key) {return iterator(find_node(key));}
+    const_iterator find(const K& key) const {return const_iterator(find_node(key));}
+
+    template <class KeyLike, class = transparent_key<KeyLike>>
+    iterator find(const KeyLike& key) {return iterator(find_node(key));}
+
+    template <class KeyLike, class = transparent_key<KeyLike>>
+    const_iterator find(const KeyLike& key) const {return const_iterator(find_node(key));}
+
+    bool contains(const K& key) const {return find_node(key) != nullptr;}
+
+    template <class KeyLike, class = transparent_key<KeyLike>>
+    bool contains(const KeyLike& key) const {return find_node(key) != nullptr;}
+
+    size_type count(const K& key) const {return contains(key);}
+
+    template <class KeyLike, class = transparent_key<KeyLike>>
+    size_type count(const KeyLike& key) const {return contains(key);}
+
+    /**
+     * @brief Constructs V from args in place, unless the key is already present.
+     *
+     * The key and arguments are only moved from when the entry is inserted.
+     *
+     * @return The entry of the key and whether it was inserted.
+     * @throws std::bad_alloc if the node or the C table fails to allocate.
+     */
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {return emplace_key(key, std::forward<Args>(args)...);}
+
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {return emplace_key(std::move(key), std::forward<Args>(args)...);}
+
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(K&& key, M&& value)
+    {
+        auto result = emplace_key(std::move(key), std::forward<M>(value));
+
+        if (!result.second) result.first->second = std::forward<M>(value);
+
+        return result;
+    }
+
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(const K& key, M&& value)
+    {
+        auto result = emplace_key(key, std::forward<M>(value));
+
+        if (!result.second) result.first->second = std::forward<M>(value);
+
+        return result;
+    }
+
+    V& operator[](const K& key) {return emplace_key(key).first->second;}
+    V& operator[](K&& key) {return emplace_key(std::move(key)).first->second;}
+
+    iterator erase(const_iterator position)
+    {
+        node* next = position.current->next;
+
+        erase_node(position.current);
+        return iterator(next);
+    }
+
+    iterator erase(iterator position) {return erase(const_iterator(position));}
+
+    size_type erase(const K& key)
+    {
+        node* found = find_node(key);
+
+        if (!found) return 0;
+
+        erase_node(found);
+        return 1;
+    }
+
+    template <class KeyLike, class = transparent_key<KeyLike>,
+              class = std::enable_if_t<!std::is_convertible_v<KeyLike, iterator> && !std::is_convertible_v<KeyLike, const_iterator>>>
+    size_type erase(KeyLike&& key)
+    {
+        node* found = find_node(key);
+
+        if (!found) return 0;
+
+        erase_node(found);
+        return 1;
+    }
+
+    void clear() noexcept
+    {
+        for (node* current = head; current; current = current->next)
+        {
+            ght_delete(core, static_cast<ght_key_t>(current->hash));
+        }
+
+        destroy_nodes();
+        head = nullptr;
+        entries = 0;
+    }
+
+    /**
+     * @brief Grows the C table so that capacity entries fit without any further resize.
+     *
+     * @throws std::bad_alloc if ght_reserve fails.
+     */
+    void reserve(size_type capacity)
+    {
+        if (ght_reserve(core, capacity)) throw std::bad_alloc();
+    }
+
+    void swap(table& other) noexcept
+    {
+        using std::swap;
+
+        swap(core, other.core);
+        swap(head, other.head);
+        swap(entries, other.entries);
+        swap(hash, other.hash);
+        swap(equal, other.equal);
+        swap(alloc, other.alloc);
+    }
+
+    friend void swap(table& a, table& b) noexcept {a.swap(b);}
+
+    hasher hash_function() const {return hash;}
+    key_equal key_eq() const {return equal;}
+    allocator_type get_allocator() const {return allocator_type(alloc);}
+
+    // The underlying C table, for ght_load, ght_width and the like.
+    ght_table_t* native_handle() const noexcept {return core;}
+
+private:
+    ght_table_t* core = nullptr;
+    node* head = nullptr;
+    size_type entries = 0;
+    Hash hash;
+    Eq equal;
+    node_allocator alloc;
+
+    table(const ght_cfg_t* cfg, const Hash& hash_fn, const Eq& comparator, const Alloc& allocator)
+        : hash(hash_fn), equal(comparator), alloc(allocator)
+    {
+        ght_cfg_t copy = cfg ? *cfg : ght_cfg_t{};
+
+        // Without a configuration the table grows like the standard containers do, at a load factor of 1.
+        if (!cfg) copy.auto_resize = 1.0;
+
+        copy.deallocator = nullptr;
+        copy.key_mode = GHT_KEY_INTEGER;
+        core = ght_create(&copy);
+
+        if (!core) throw std::bad_alloc();
+    }
+
+    static node* as_node(ght_data_t data) noexcept {return reinterpret_cast<node*>(data);}
+
+    template <class KeyLike>
+    node* find_node(const KeyLike& key) const
+    {
+        node* current = as_node(ght_search(core, static_cast<ght_key_t>(hash(key))));
+
+        while (current && !equal(current->value.first, key)) current = current->chain;
+
+        return current;
+    }
+
+    template <class KeyArg, class... Args>
+    std::pair<iterator, bool> emplace_key(KeyArg&& key, Args&&... args)
+    {
+        std::size_t digest = hash(key);
+        node* first = as_node(ght_search(core, static_cast<ght_key_t>(digest)));
+
+        for (node* current = first; current; current = current->chain)
+        {
+            if (equal(current->value.first, key)) return {iterator(current), false};
+        }
+
+        node* created = node_traits::allocate(alloc, 1);
+
+        try
+        {
+            node_traits::construct(alloc, std::addressof(created->value), std::piecewise_construct,
+                                   std::forward_as_tuple(std::forward<KeyArg>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+        catch (...)
+        {
+            node_traits::deallocate(alloc, created, 1);
+            throw;
+        }
+
+        created->hash = digest;
+        created->chain = first;
+
+        if (ght_insert(core, static_cast<ght_key_t>(digest), reinterpret_cast<ght_data_t>(created)))
+        {
+            free_node(created);
+            throw std::bad_alloc();
+        }
+
+        created->prev = nullptr;
+        created->next = head;
+
+        if (head) head->prev = created;
+
+        head = created;
+        entries++;
+
+        return {iterator(created), true};
+    }
+
+    void erase_node(node* target)
+    {
+        ght_key_t key = static_cast<ght_key_t>(target->hash);
+        node* first = as_node(ght_search(core, key));
+
+        if (first == target)
+        {
+            // Read-mostly tables copy the C node on replacement, which can fail before anything changed.
+            if (target->chain && ght_insert(core, key, reinterpret_cast<ght_data_t>(target->chain))) throw std::bad_alloc();
+            if (!target->chain) ght_delete(core, key);
+        }
+        else
+        {
+            while (first->chain != target) first = first->chain;
+
+            first->chain = target->chain;
+        }
+
+        if (target->prev) target->prev->next = target->next;
+        else head = target->next;
+
+        if (target->next) target->next->prev = target->prev;
+
+        free_node(target);
+        entries--;
+    }
+
+    void free_node(node* target) noexcept
+    {
+        node_traits::destroy(alloc, std::addressof(target->value));
+        node_traits::deallocate(alloc, target, 1);
+    }
+
+    void destroy_nodes() noexcept
+    {
+        for (node* current = head; current;)
+        {
+            node* next = current->next;
+
+            free_node(current);
+            current = next;
+        }
+    }
+};
+
+} // namespace ght
+
+#endif /* GHT_HPP */
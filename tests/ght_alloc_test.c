@@ -0,0 +1,268 @@
+// Allocator hooks: every engine takes all its memory from the configured functions, always with their context, and
+// hands every block back by the time it is destroyed. Incomplete sets of functions are rejected.
+
+#include <stdatomic.h>
+
+#include "ght_test.h"
+
+static atomic_size_t _live;             // Blocks handed out and not freed yet.
+static atomic_size_t _calls;
+static char _context;                   // Only its address is passed around.
+
+static void* _malloc(size_t size, void* context)
+{
+    void* ptr = malloc(size);
+    
+    CHECK(context == &_context);
+    
+    if (ptr) atomic_fetch_add(&_live, 1);
+    
+    atomic_fetch_add(&_calls, 1);
+    return ptr;
+}
+
+static void* _calloc(size_t count, size_t size, void* context)
+{
+    void* ptr = calloc(count, size);
+    
+    CHECK(context == &_context);
+    
+    if (ptr) atomic_fetch_add(&_live, 1);
+    
+    atomic_fetch_add(&_calls, 1);
+    return ptr;
+}
+
+static void* _realloc(void* ptr, size_t size, void* context)
+{
+    void* block = realloc(ptr, size);
+    
+    CHECK(context == &_context);
+    
+    if (block && !ptr) atomic_fetch_add(&_live, 1);
+    
+    atomic_fetch_add(&_calls, 1);
+    return block;
+}
+
+static void* _aligned_alloc(size_t alignment, size_t size, void* context)
+{
+    void* ptr = aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    
+    CHECK(context == &_context);
+    CHECK(((uintptr_t) ptr & (alignment - 1)) == 0);
+    
+    if (ptr) atomic_fetch_add(&_live, 1);
+    
+    atomic_fetch_add(&_calls, 1);
+    return ptr;
+}
+
+static void _free(void* ptr, void* context)
+{
+    CHECK(context == &_context);
+    CHECK(ptr);
+    CHECK(atomic_fetch_sub(&_live, 1) > 0);
+    free(ptr);
+}
+
+static const ght_allocator_t _allocators[] =
+{
+    {.malloc = _malloc, .calloc = _calloc, .realloc = _realloc, .free = _free, .aligned_alloc = _aligned_alloc, .context = &_context},
+    {.malloc = _malloc, .free = _free, .context = &_context},
+    {.realloc = _realloc, .free = _free, .context = &_context},
+};
+
+static int _worker(void* arg)
+{
+    ght_test_thread_t* thread = arg;
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(thread->id, i);
+        
+        CHECK(!ght_insert(thread->table, key, ght_test_data(key, 0)));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i += 2)
+    {
+        ght_key_t key = ght_test_key(thread->id, i);
+        
+        CHECK(!ght_insert(thread->table, key, ght_test_data(key, 1)));
+        CHECK(!ght_delete(thread->table, ght_test_key(thread->id, i + 1)));
+    }
+    
+    return 0;
+}
+
+static int _lf_worker(void* arg)
+{
+    ght_test_thread_t* thread = arg;
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(thread->id, i);
+        
+        CHECK(!ght_lf_insert(thread->table, key, ght_test_data(key, 0)));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i += 2)
+    {
+        ght_key_t key = ght_test_key(thread->id, i);
+        
+        CHECK(!ght_lf_insert(thread->table, key, ght_test_data(key, 1)));
+        CHECK(!ght_lf_delete(thread->table, ght_test_key(thread->id, i + 1)));
+    }
+    
+    ght_thread_unregister();
+    return 0;
+}
+
+static int _sharded_worker(void* arg)
+{
+    ght_test_thread_t* thread = arg;
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(thread->id, i);
+        
+        CHECK(!ght_sharded_insert(thread->table, key, ght_test_data(key, 0)));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i += 2)
+    {
+        CHECK(!ght_sharded_delete(thread->table, ght_test_key(thread->id, i + 1)));
+    }
+    
+    return 0;
+}
+
+static void _table(ght_cfg_t cfg)
+{
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    ght_test_run(_worker, table);
+    
+    CHECK(ght_load(table) == GHT_TEST_THREADS * GHT_TEST_KEYS / 2);
+    CHECK(!ght_resize(table, ght_width(table) * 2));
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i += 2)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(ght_search(table, key) == ght_test_data(key, 1));
+        CHECK(!ght_search(table, ght_test_key(0, i + 1)));
+    }
+    
+    CHECK(!ght_destroy(table));
+}
+
+static void _bytes(ght_cfg_t cfg)
+{
+    char key[64];
+    
+    // Keys past key_inline live in their own allocation.
+    cfg.key_mode = GHT_KEY_BYTES;
+    cfg.key_inline = 8;
+    
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        int length = snprintf(key, sizeof(key), i % 2 ? "%zu" : "a much longer key %zu", i);
+        
+        CHECK(!ght_insert_bytes(table, key, length, i + 1));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i += 4)
+    {
+        int length = snprintf(key, sizeof(key), "a much longer key %zu", i);
+        
+        CHECK(!ght_delete_bytes(table, key, length));
+    }
+    
+    CHECK(ght_load(table) == GHT_TEST_KEYS - GHT_TEST_KEYS / 4);
+    CHECK(!ght_destroy(table));
+}
+
+static bool _accepts(ght_allocator_t allocator)
+{
+    ght_cfg_t cfg = {.allocator = allocator};
+    ght_table_t* table = ght_create(&cfg);
+    ght_lf_table_t* lf = ght_lf_create(&cfg);
+    ght_sharded_t* sharded = ght_sharded_create(&cfg, 4);
+    
+    CHECK(!table == !lf && !lf == !sharded);
+    
+    if (!table) return false;
+    
+    CHECK(!ght_destroy(table));
+    CHECK(!ght_lf_destroy(lf));
+    CHECK(!ght_sharded_destroy(sharded));
+    return true;
+}
+
+int main(void)
+{
+    CHECK(_accepts((ght_allocator_t) {0}));
+    CHECK(_accepts((ght_allocator_t) {.malloc = _malloc, .free = _free, .context = &_context}));
+    CHECK(_accepts((ght_allocator_t) {.realloc = _realloc, .free = _free, .context = &_context}));
+    CHECK(!_accepts((ght_allocator_t) {.malloc = _malloc, .context = &_context}));
+    CHECK(!_accepts((ght_allocator_t) {.calloc = _calloc, .free = _free, .context = &_context}));
+    CHECK(!_accepts((ght_allocator_t) {.aligned_alloc = _aligned_alloc, .free = _free, .context = &_context}));
+    CHECK(!_accepts((ght_allocator_t) {.free = _free, .context = &_context}));
+    CHECK(atomic_load(&_live) == 0);
+    
+    for (size_t a = 0; a < sizeof(_allocators) / sizeof(_allocators[0]); a++)
+    {
+        const ght_cfg_t configs[] =
+        {
+            {.width = 64, .auto_resize = 0.75, .allocator = _allocators[a]},
+            {.width = 64, .auto_resize = 0.75, .node_pool = true, .allocator = _allocators[a]},
+            {.width = 64, .auto_resize = 0.75, .lock_stripes = 16, .node_pool = true, .allocator = _allocators[a]},
+            {.width = 64, .auto_resize = 0.75, .read_mostly = true, .allocator = _allocators[a]},
+            {.width = 64, .auto_resize = 0.75, .resize_mode = GHT_RESIZE_INCREMENTAL, .allocator = _allocators[a]},
+            {.width = 64, .auto_resize = 0.75, .resize_mode = GHT_RESIZE_COOPERATIVE, .allocator = _allocators[a]},
+            {.width = 64, .auto_resize = 0.75, .auto_shrink = 0.25, .engine = GHT_ENGINE_OPEN_ADDRESSING, .allocator = _allocators[a]},
+            {.width = 64, .auto_resize = 0.75, .engine = GHT_ENGINE_ROBIN_HOOD, .allocator = _allocators[a]},
+            {.width = 64, .auto_resize = 0.75, .engine = GHT_ENGINE_CUCKOO, .allocator = _allocators[a]},
+        };
+        
+        for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+        {
+            atomic_store(&_calls, 0);
+            _table(configs[c]);
+            CHECK(atomic_load(&_calls) > 0);
+            CHECK(atomic_load(&_live) == 0);
+        }
+        
+        atomic_store(&_calls, 0);
+        _bytes(configs[0]);
+        _bytes(configs[1]);
+        CHECK(atomic_load(&_calls) > 0);
+        CHECK(atomic_load(&_live) == 0);
+        
+        // The reclaimer frees retired nodes through the allocator of their table, at the latest on its destroy.
+        ght_lf_table_t* lf = ght_lf_create(&(ght_cfg_t) {.width = 64, .auto_resize = 1.0, .allocator = _allocators[a]});
+        
+        CHECK(lf);
+        ght_test_run(_lf_worker, lf);
+        CHECK(!ght_lf_destroy(lf));
+        CHECK(atomic_load(&_live) == 0);
+        
+        ght_sharded_t* sharded = ght_sharded_create(&(ght_cfg_t) {.width = 64, .auto_resize = 0.75, .allocator = _allocators[a]}, 8);
+        
+        CHECK(sharded);
+        ght_test_run(_sharded_worker, sharded);
+        CHECK(ght_sharded_load(sharded) == GHT_TEST_THREADS * GHT_TEST_KEYS / 2);
+        CHECK(!ght_sharded_destroy(sharded));
+        CHECK(atomic_load(&_live) == 0);
+    }
+    
+    ght_thread_unregister();
+    return 0;
+}
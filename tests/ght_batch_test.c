@@ -0,0 +1,77 @@
+// Batched lookups: ght_search_batch must return what ght_search returns for each key, on every engine and table mode,
+// for batches of any length holding misses and repeated keys, with or without the found array.
+
+#include "ght_test.h"
+
+#define GHT_TEST_BATCH      (1000)      // Not a multiple of the internal batch size.
+
+static void _compare(ght_cfg_t cfg)
+{
+    static ght_key_t keys[GHT_TEST_BATCH];
+    static ght_data_t data[GHT_TEST_BATCH];
+    static bool found[GHT_TEST_BATCH];
+    
+    cfg.width = 64;
+    cfg.auto_resize = 1.0;
+    
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i += 2)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+    }
+    
+    // Incremental and cooperative tables answer from both arrays while a resize is still moving keys.
+    CHECK(!ght_resize(table, GHT_TEST_KEYS * 2));
+    
+    for (size_t i = 0; i < GHT_TEST_BATCH; i++)
+    {
+        keys[i] = ght_test_key(0, i * 7 % (GHT_TEST_BATCH / 2));
+    }
+    
+    for (size_t count = 0; count <= GHT_TEST_BATCH; count += count < 20 ? 1 : 245)
+    {
+        size_t hits = 0;
+        
+        for (size_t i = 0; i < count; i++)
+        {
+            data[i] = 1;
+            found[i] = true;
+            hits += ght_search(table, keys[i]) != 0;
+        }
+        
+        CHECK(ght_search_batch(table, keys, data, found, count) == hits);
+        
+        for (size_t i = 0; i < count; i++)
+        {
+            CHECK(data[i] == ght_search(table, keys[i]));
+            CHECK(found[i] == (data[i] != 0));
+        }
+        
+        CHECK(ght_search_batch(table, keys, data, NULL, count) == hits);
+    }
+    
+    CHECK(!ght_destroy(table));
+}
+
+int main(void)
+{
+    _compare((ght_cfg_t) {0});
+    _compare((ght_cfg_t) {.node_pool = true, .lock_stripes = 8});
+    _compare((ght_cfg_t) {.read_mostly = true});
+    _compare((ght_cfg_t) {.resize_mode = GHT_RESIZE_INCREMENTAL});
+    _compare((ght_cfg_t) {.resize_mode = GHT_RESIZE_COOPERATIVE, .lock_stripes = 8});
+    _compare((ght_cfg_t) {.index_policy = GHT_INDEX_POW2});
+    _compare((ght_cfg_t) {.engine = GHT_ENGINE_OPEN_ADDRESSING});
+    _compare((ght_cfg_t) {.engine = GHT_ENGINE_ROBIN_HOOD});
+    _compare((ght_cfg_t) {.engine = GHT_ENGINE_CUCKOO});
+    
+    CHECK(!ght_search_batch(NULL, NULL, NULL, NULL, 0));
+    ght_thread_unregister();
+    
+    return 0;
+}
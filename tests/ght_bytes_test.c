@@ -0,0 +1,167 @@
+// Byte keys: keys up to key_inline bytes live in the node and longer ones in their own allocation. Both must compare
+// by content and length, survive the caller's buffer and resizes, and reach the deallocator as the stored copy.
+
+#include <ctype.h>
+
+#include "ght_test.h"
+
+#define GHT_TEST_INLINE     (16)
+#define GHT_TEST_COUNT      (5000)
+
+static long _live;
+static size_t _deallocated;
+
+static void* _malloc(size_t size, void* context)
+{
+    (void) context;
+    _live++;
+    return malloc(size);
+}
+
+static void _free(void* ptr, void* context)
+{
+    (void) context;
+    _live -= ptr != NULL;
+    free(ptr);
+}
+
+// Key i is its number followed by i % 40 dashes, so lengths cross key_inline and keys share prefixes.
+static size_t _key(size_t i, char* key)
+{
+    int length = sprintf(key, "%zu", i);
+    
+    memset(key + length, '-', i % 40);
+    return (size_t) length + i % 40;
+}
+
+static void _deallocator(ght_key_t key, ght_data_t data)
+{
+    char expected[64];
+    size_t length = data > GHT_TEST_COUNT ? 0 : _key((size_t) data - 1, expected);
+    
+    CHECK(!length || !memcmp((const void*) (uintptr_t) key, expected, length));
+    _deallocated++;
+}
+
+static ght_hash_t _fold_hash(const void* key, size_t length)
+{
+    ght_hash_t hash = 0;
+    
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = hash * 31 + (ght_hash_t) tolower(((const unsigned char*) key)[i]);
+    }
+    
+    return hash;
+}
+
+static bool _fold_equal(const void* a, const void* b, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        if (tolower(((const unsigned char*) a)[i]) != tolower(((const unsigned char*) b)[i])) return false;
+    }
+    
+    return true;
+}
+
+static void _keys(ght_cfg_t cfg)
+{
+    char key[64];
+    
+    _deallocated = 0;
+    cfg.key_mode = GHT_KEY_BYTES;
+    cfg.key_inline = GHT_TEST_INLINE;
+    cfg.width = 64;
+    cfg.auto_resize = 1.0;
+    cfg.deallocator = _deallocator;
+    cfg.allocator = (ght_allocator_t) {.malloc = _malloc, .free = _free};
+    
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    // The integer functions don't apply to byte keys.
+    CHECK(ght_insert(table, 1, 1));
+    CHECK(!ght_search(table, 1));
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        size_t length = _key(i, key);
+        
+        CHECK(!ght_insert_bytes(table, key, length, i + 1));
+        
+        // The table keeps its own copy, the buffer is reused right away.
+        memset(key, 'x', sizeof(key));
+    }
+    
+    // Prefixes of stored keys are other keys or no key at all.
+    CHECK(!ght_search_bytes(table, "1--", 3));
+    CHECK(!ght_search_bytes(table, "", 0));
+    CHECK(!ght_insert_bytes(table, "", 0, GHT_TEST_COUNT + 1));
+    CHECK(ght_search_bytes(table, "", 0) == GHT_TEST_COUNT + 1);
+    CHECK(!ght_delete_bytes(table, "", 0));
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        size_t length = _key(i, key);
+        
+        CHECK(ght_search_bytes(table, key, length) == i + 1);
+        CHECK(!ght_search_bytes(table, key, length + 1));
+        
+        if (i % 2)
+        {
+            CHECK(!ght_delete_bytes(table, key, length));
+            CHECK(ght_delete_bytes(table, key, length));
+        }
+    }
+    
+    CHECK(ght_load(table) == GHT_TEST_COUNT / 2);
+    
+    // Read-mostly tables defer the deallocator until the readers are done with the old node.
+    CHECK(cfg.read_mostly || _deallocated == GHT_TEST_COUNT / 2 + 1);
+    
+    // Reinserted keys take the nodes freed by the deletes, whatever length those held before.
+    for (size_t i = 1; i < GHT_TEST_COUNT; i += 2)
+    {
+        size_t length = _key(i, key);
+        
+        CHECK(!ght_insert_bytes(table, key, length, i + 1));
+    }
+    
+    CHECK(!ght_resize(table, 1024));
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        size_t length = _key(i, key);
+        
+        CHECK(ght_search_bytes(table, key, length) == i + 1);
+    }
+    
+    _deallocated = 0;
+    CHECK(!ght_destroy(table));
+    CHECK(_deallocated == GHT_TEST_COUNT);
+    CHECK(!_live);
+}
+
+int main(void)
+{
+    _keys((ght_cfg_t) {0});
+    _keys((ght_cfg_t) {.node_pool = true});
+    _keys((ght_cfg_t) {.lock_stripes = 8, .read_mostly = true});
+    
+    // A digestor and comparator that agree on a case-insensitive equality.
+    ght_cfg_t cfg = {.key_mode = GHT_KEY_BYTES, .bytes_digestor = _fold_hash, .comparator = _fold_equal};
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    CHECK(!ght_insert_bytes(table, "Hash Table", 10, 1));
+    CHECK(!ght_insert_bytes(table, "HASH TABLE", 10, 2));
+    CHECK(ght_load(table) == 1);
+    CHECK(ght_search_bytes(table, "hash table", 10) == 2);
+    CHECK(!ght_search_bytes(table, "hash tabl", 9));
+    CHECK(!ght_destroy(table));
+    ght_thread_unregister();
+    
+    return 0;
+}
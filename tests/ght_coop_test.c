@@ -0,0 +1,152 @@
+// Cooperative resize: ght_resize only swaps in the new bucket array, then every operation moves one stride of old
+// buckets and forwards them. Lookups must follow forwarded buckets into the new array, and the old array must be
+// freed by the operation that forwards its last bucket.
+
+#include <stdatomic.h>
+
+#include "ght_test.h"
+
+#define GHT_TEST_WIDTH      (256)
+#define GHT_TEST_STRIDE     (16)        // Old buckets moved by each operation.
+
+static atomic_long _live;               // Blocks allocated by the tables and not freed yet.
+static atomic_size_t _deallocated;
+static atomic_bool _done;
+
+static void* _malloc(size_t size, void* context)
+{
+    (void) context;
+    atomic_fetch_add_explicit(&_live, 1, memory_order_relaxed);
+    return malloc(size);
+}
+
+static void _free(void* ptr, void* context)
+{
+    (void) context;
+    
+    if (ptr)
+    {
+        atomic_fetch_sub_explicit(&_live, 1, memory_order_relaxed);
+    }
+    
+    free(ptr);
+}
+
+static void _deallocator(ght_key_t key, ght_data_t data)
+{
+    CHECK(data >> 8 == key);
+    atomic_fetch_add_explicit(&_deallocated, 1, memory_order_relaxed);
+}
+
+static int _worker(void* arg)
+{
+    ght_test_thread_t* thread = arg;
+    ght_table_t* table = thread->table;
+    size_t i = thread->id;
+    
+    // Starts transfers while the other threads insert, each resize first finishes whatever the previous one left.
+    if (!thread->id)
+    {
+        for (ght_width_t width = GHT_TEST_WIDTH * 8; width <= GHT_TEST_WIDTH * 64; width *= 2)
+        {
+            CHECK(!ght_resize(table, width));
+            
+            for (size_t j = 0; j < GHT_TEST_KEYS / 8; j++)
+            {
+                ght_key_t stable = ght_test_key(0, i++ % GHT_TEST_KEYS);
+                
+                CHECK(ght_search(table, stable) == ght_test_data(stable, 0));
+            }
+        }
+        
+        atomic_store_explicit(&_done, true, memory_order_release);
+        return 0;
+    }
+    
+    for (size_t j = 0; j < GHT_TEST_KEYS || !atomic_load_explicit(&_done, memory_order_acquire); j++)
+    {
+        ght_key_t stable = ght_test_key(0, i % GHT_TEST_KEYS);
+        
+        CHECK(ght_search(table, stable) == ght_test_data(stable, 0));
+        i += 7;
+        
+        if (j < GHT_TEST_KEYS)
+        {
+            ght_key_t key = ght_test_key(thread->id, j);
+            
+            CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+        }
+    }
+    
+    return 0;
+}
+
+int main(void)
+{
+    ght_cfg_t cfg = {
+                        .width = GHT_TEST_WIDTH,
+                        .auto_resize = 0.0,
+                        .lock_stripes = 8,
+                        .resize_mode = GHT_RESIZE_COOPERATIVE,
+                        .deallocator = _deallocator,
+                        .allocator = {.malloc = _malloc, .free = _free}
+                    };
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+    }
+    
+    long live = atomic_load(&_live);
+    
+    CHECK(!ght_resize(table, GHT_TEST_WIDTH * 4));
+    CHECK(ght_width(table) == GHT_TEST_WIDTH * 4);
+    CHECK(atomic_load(&_live) == live + 1);
+    
+    // Each search forwards one stride before its lookup, which finds the key in whichever array holds it by then.
+    for (size_t i = 0; i < GHT_TEST_WIDTH / GHT_TEST_STRIDE; i++)
+    {
+        ght_key_t key = ght_test_key(0, i * 1237 % GHT_TEST_KEYS);
+        
+        CHECK(atomic_load(&_live) == live + 1);
+        CHECK(ght_search(table, key) == ght_test_data(key, 0));
+    }
+    
+    // The search that forwarded the last bucket freed the old array.
+    CHECK(atomic_load(&_live) == live);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(ght_search(table, key) == ght_test_data(key, 0));
+    }
+    
+    ght_test_run(_worker, table);
+    
+    // Operations that follow the last resize finish its transfer.
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        for (size_t id = 0; id < GHT_TEST_THREADS; id++)
+        {
+            ght_key_t key = ght_test_key(id, i);
+            
+            CHECK(ght_search(table, key) == ght_test_data(key, 0));
+        }
+    }
+    
+    CHECK(ght_width(table) == GHT_TEST_WIDTH * 64);
+    CHECK(ght_load(table) == GHT_TEST_THREADS * GHT_TEST_KEYS);
+    
+    // Every node moved exactly once: destroying the table hands each entry to the deallocator once and frees it all.
+    CHECK(!ght_destroy(table));
+    CHECK(atomic_load(&_deallocated) == GHT_TEST_THREADS * GHT_TEST_KEYS);
+    CHECK(!atomic_load(&_live));
+    
+    return 0;
+}
@@ -0,0 +1,102 @@
+// Cuckoo displacement: with auto_resize off, a table only grows when no displacement path frees a slot, so it must
+// reach a load that two choices of 4 slots alone cannot. Lock-free readers racing the inserts must find every key
+// already inserted, even while a displacement path is moving it to its other bucket.
+
+#include <stdatomic.h>
+
+#include "ght_test.h"
+
+#define GHT_TEST_WIDTH      (4096)
+#define GHT_TEST_WAYS       (4)                         // Slots per bucket.
+#define GHT_TEST_FILL       (GHT_TEST_WIDTH * 9 / 10)   // Keys inserted, a 0.9 load factor.
+
+static atomic_size_t _inserted;
+static atomic_bool _done;
+
+static ght_hash_t _constant(ght_key_t key)
+{
+    (void) key;
+    return 0x5bd1e995;
+}
+
+static int _worker(void* arg)
+{
+    ght_test_thread_t* thread = arg;
+    ght_table_t* table = thread->table;
+    size_t i = thread->id;
+    
+    if (!thread->id)
+    {
+        for (size_t j = 0; j < GHT_TEST_FILL; j++)
+        {
+            ght_key_t key = ght_test_key(0, j);
+            
+            CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+            atomic_store_explicit(&_inserted, j + 1, memory_order_release);
+        }
+        
+        atomic_store_explicit(&_done, true, memory_order_release);
+        return 0;
+    }
+    
+    while (!atomic_load_explicit(&_done, memory_order_acquire))
+    {
+        size_t inserted = atomic_load_explicit(&_inserted, memory_order_acquire);
+        
+        if (!inserted) continue;
+        
+        ght_key_t key = ght_test_key(0, i % inserted);
+        
+        CHECK(ght_search(table, key) == ght_test_data(key, 0));
+        i += 7;
+    }
+    
+    return 0;
+}
+
+int main(void)
+{
+    ght_cfg_t cfg = {.engine = GHT_ENGINE_CUCKOO, .width = GHT_TEST_WIDTH, .auto_resize = 0.0, .lock_stripes = 64};
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    CHECK(ght_width(table) == GHT_TEST_WIDTH);
+    
+    ght_test_run(_worker, table);
+    
+    CHECK(ght_width(table) == GHT_TEST_WIDTH);
+    CHECK(ght_load(table) == GHT_TEST_FILL);
+    
+    for (size_t j = 0; j < GHT_TEST_FILL; j++)
+    {
+        ght_key_t key = ght_test_key(0, j);
+        
+        CHECK(ght_search(table, key) == ght_test_data(key, 0));
+    }
+    
+    CHECK(!ght_destroy(table));
+    
+    // Keys that share their whole hash share both buckets, so the ninth finds no room at any size.
+    cfg = (ght_cfg_t) {.engine = GHT_ENGINE_CUCKOO, .width = 64, .digestor = _constant};
+    table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    for (ght_key_t key = 1; key <= 2 * GHT_TEST_WAYS; key++)
+    {
+        CHECK(!ght_insert(table, key, key));
+    }
+    
+    CHECK(ght_insert(table, 2 * GHT_TEST_WAYS + 1, 1));
+    CHECK(ght_load(table) == 2 * GHT_TEST_WAYS);
+    
+    for (ght_key_t key = 1; key <= 2 * GHT_TEST_WAYS; key++)
+    {
+        CHECK(ght_search(table, key) == key);
+    }
+    
+    CHECK(!ght_destroy(table));
+    ght_thread_unregister();
+    
+    return 0;
+}
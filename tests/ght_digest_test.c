@@ -0,0 +1,96 @@
+// Built-in digestors: each digest resolves to its instructions when the CPU has them and to Murmur3 otherwise, hashes
+// depend on the seed and not on the table, and every choice spreads sequential keys without collisions.
+
+#include "ght_test.h"
+
+#define GHT_TEST_COUNT      (5000)
+#define GHT_TEST_SEED       (0x0123456789abcdef)
+
+static ght_table_t* _create(ght_digest_t digest, uint64_t seed)
+{
+    ght_cfg_t cfg = {.digest = digest, .seed = seed, .width = 64, .auto_resize = 1.0};
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    return table;
+}
+
+// Whether two digests hash the same, compared on a few keys.
+static bool _same(ght_digest_t a, ght_digest_t b)
+{
+    ght_table_t* first = _create(a, GHT_TEST_SEED);
+    ght_table_t* second = _create(b, GHT_TEST_SEED);
+    bool same = true;
+    
+    for (ght_key_t key = 0; key < 16; key++)
+    {
+        same &= ght_hash(first, key) == ght_hash(second, key);
+    }
+    
+    CHECK(!ght_destroy(first));
+    CHECK(!ght_destroy(second));
+    return same;
+}
+
+static int _compare_hashes(const void* a, const void* b)
+{
+    ght_hash_t x = *(const ght_hash_t*) a;
+    ght_hash_t y = *(const ght_hash_t*) b;
+    
+    return (x > y) - (x < y);
+}
+
+static void _digest(ght_digest_t digest)
+{
+    static ght_hash_t hashes[GHT_TEST_COUNT];
+    ght_table_t* table = _create(digest, GHT_TEST_SEED);
+    ght_table_t* reseeded = _create(digest, GHT_TEST_SEED + 1);
+    size_t differ = 0;
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        hashes[i] = ght_hash(table, i);
+        differ += hashes[i] != ght_hash(reseeded, i);
+        
+        CHECK(!ght_insert(table, i, i + 1));
+    }
+    
+    CHECK(differ == GHT_TEST_COUNT);
+    
+    qsort(hashes, GHT_TEST_COUNT, sizeof(ght_hash_t), _compare_hashes);
+    
+    for (size_t i = 1; i < GHT_TEST_COUNT; i++)
+    {
+        CHECK(hashes[i] != hashes[i - 1]);
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        CHECK(ght_search(table, i) == i + 1);
+    }
+    
+    CHECK(!ght_destroy(table));
+    CHECK(!ght_destroy(reseeded));
+}
+
+int main(void)
+{
+    bool aes = false;
+    bool crc32c = false;
+    
+#if defined(__x86_64__) && defined(__GNUC__)
+    __builtin_cpu_init();
+    aes = __builtin_cpu_supports("aes");
+    crc32c = __builtin_cpu_supports("sse4.2");
+#endif
+    
+    CHECK(_same(GHT_DIGEST_AUTO, GHT_DIGEST_AES));
+    CHECK(_same(GHT_DIGEST_AES, GHT_DIGEST_MURMUR3) == !aes);
+    CHECK(_same(GHT_DIGEST_CRC32C, GHT_DIGEST_MURMUR3) == !crc32c);
+    
+    _digest(GHT_DIGEST_MURMUR3);
+    _digest(GHT_DIGEST_AES);
+    _digest(GHT_DIGEST_CRC32C);
+    
+    return 0;
+}
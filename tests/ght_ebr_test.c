@@ -0,0 +1,104 @@
+// Read-mostly table whose lock-free readers race writers that replace and delete, so every node and value goes through
+// the epoch reclaimer. Each value must reach the deallocator exactly once, and readers must never see a reused node.
+
+#include <stdatomic.h>
+
+#include "ght_test.h"
+
+#define GHT_TEST_WRITERS    (GHT_TEST_THREADS / 2)
+
+static atomic_size_t _deallocated;
+static atomic_size_t _writing = GHT_TEST_WRITERS;
+
+static void _deallocator(ght_key_t key, ght_data_t data)
+{
+    CHECK(data >> 8 == key);
+    atomic_fetch_add_explicit(&_deallocated, 1, memory_order_relaxed);
+}
+
+static void _write(ght_table_t* table, size_t id)
+{
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(id, i);
+        
+        CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(id, i);
+        
+        if (i % 2)
+        {
+            CHECK(!ght_delete(table, key));
+        }
+        else
+        {
+            CHECK(!ght_insert(table, key, ght_test_data(key, 1)));
+        }
+    }
+    
+    atomic_fetch_sub_explicit(&_writing, 1, memory_order_release);
+}
+
+static void _read(ght_table_t* table, size_t id)
+{
+    size_t i = id;
+    
+    // A node freed too early and reused for another key would show up as data of the wrong key.
+    while (atomic_load_explicit(&_writing, memory_order_acquire))
+    {
+        ght_key_t key = ght_test_key(i % GHT_TEST_WRITERS, i / GHT_TEST_WRITERS % GHT_TEST_KEYS);
+        ght_data_t data = ght_search(table, key);
+        
+        CHECK(!data || data == ght_test_data(key, 0) || data == ght_test_data(key, 1));
+        i += 7;
+    }
+}
+
+static int _worker(void* arg)
+{
+    ght_test_thread_t* thread = arg;
+    
+    if (thread->id < GHT_TEST_WRITERS)
+    {
+        _write(thread->table, thread->id);
+    }
+    else
+    {
+        _read(thread->table, thread->id);
+    }
+    
+    return 0;
+}
+
+int main(void)
+{
+    // A small table, so resizes retire whole bucket arrays on top of the nodes.
+    ght_cfg_t cfg = {.width = 64, .auto_resize = 1.0, .lock_stripes = 8, .read_mostly = true, .deallocator = _deallocator};
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    ght_test_run(_worker, table);
+    
+    CHECK(ght_load(table) == GHT_TEST_WRITERS * GHT_TEST_KEYS / 2);
+    
+    for (size_t id = 0; id < GHT_TEST_WRITERS; id++)
+    {
+        for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+        {
+            ght_key_t key = ght_test_key(id, i);
+            
+            CHECK(ght_search(table, key) == (i % 2 ? 0 : ght_test_data(key, 1)));
+        }
+    }
+    
+    // Every value inserted was replaced, deleted or is still in the table, and destroying the table flushes them all.
+    CHECK(!ght_destroy(table));
+    CHECK(atomic_load(&_deallocated) == GHT_TEST_WRITERS * GHT_TEST_KEYS * 3 / 2);
+    ght_thread_unregister();
+    
+    return 0;
+}
@@ -0,0 +1,150 @@
+// Precomputed hashes: the _hashed lookups and deletes never call the digestor, agree with the plain ones on every
+// engine, accept hashes from another table with the same seed, and still find keys after a re-seed made them stale.
+
+#include "ght_test.h"
+
+#define GHT_TEST_COUNT      (2000)
+#define GHT_TEST_SEED       (42)
+
+static size_t _digests;
+
+static ght_hash_t _counting(ght_key_t key, uint64_t seed)
+{
+    _digests++;
+    return ght_digestor_mum(key, seed);
+}
+
+// Every key collides under the configured seed, so the first long chain re-seeds the table.
+static ght_hash_t _weak_seed(ght_key_t key, uint64_t seed)
+{
+    return seed == GHT_TEST_SEED ? 7 : ght_digestor_mum(key, seed);
+}
+
+static void _engine(ght_cfg_t cfg)
+{
+    static ght_hash_t hashes[GHT_TEST_COUNT];
+    
+    cfg.keyed_digestor = _counting;
+    cfg.seed = GHT_TEST_SEED;
+    cfg.width = 64;
+    cfg.auto_resize = 1.0;
+    
+    ght_table_t* table = ght_create(&cfg);
+    ght_table_t* other = ght_create(&cfg);
+    
+    CHECK(table && other);
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        hashes[i] = ght_hash(other, ght_test_key(0, i));
+        CHECK(hashes[i] == ght_hash(table, ght_test_key(0, i)));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(!ght_insert_hashed(table, hashes[i], key, ght_test_data(key, 0)));
+    }
+    
+    // The flat engines rehash their keys when they grow, lookups and deletes never hash.
+    size_t digests = _digests;
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(ght_search_hashed(table, hashes[i], key) == ght_test_data(key, 0));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i += 2)
+    {
+        CHECK(!ght_delete_hashed(table, hashes[i], ght_test_key(0, i)));
+        CHECK(ght_delete_hashed(table, hashes[i], ght_test_key(0, i)));
+    }
+    
+    CHECK(_digests == digests);
+    
+    // The plain operations hash the same way.
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(ght_search(table, key) == (i % 2 ? ght_test_data(key, 0) : 0));
+    }
+    
+    CHECK(!ght_destroy(table));
+    CHECK(!ght_destroy(other));
+}
+
+int main(void)
+{
+    _engine((ght_cfg_t) {0});
+    _engine((ght_cfg_t) {.lock_stripes = 8});
+    _engine((ght_cfg_t) {.read_mostly = true});
+    _engine((ght_cfg_t) {.resize_mode = GHT_RESIZE_COOPERATIVE, .lock_stripes = 8});
+    _engine((ght_cfg_t) {.engine = GHT_ENGINE_OPEN_ADDRESSING});
+    _engine((ght_cfg_t) {.engine = GHT_ENGINE_ROBIN_HOOD});
+    _engine((ght_cfg_t) {.engine = GHT_ENGINE_CUCKOO});
+    
+    // Random seeds differ between tables, so their hashes don't carry over.
+    ght_table_t* first = ght_create(NULL);
+    ght_table_t* second = ght_create(NULL);
+    size_t same = 0;
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        same += ght_hash(first, ght_test_key(0, i)) == ght_hash(second, ght_test_key(0, i));
+    }
+    
+    CHECK(same < GHT_TEST_COUNT);
+    CHECK(!ght_destroy(first));
+    CHECK(!ght_destroy(second));
+    
+    // Hashes taken before the re-seed are stale by the time they are used.
+    static ght_hash_t stale[GHT_TEST_COUNT];
+    ght_cfg_t cfg = {.keyed_digestor = _weak_seed, .seed = GHT_TEST_SEED, .reseed_chain = 4, .auto_resize = 1.0};
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        stale[i] = ght_hash(table, ght_test_key(0, i));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(!ght_insert_hashed(table, stale[i], key, ght_test_data(key, 0)));
+    }
+    
+    CHECK(ght_hash(table, ght_test_key(0, 0)) != stale[0]);
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(ght_search_hashed(table, stale[i], key) == ght_test_data(key, 0));
+        CHECK(ght_search(table, key) == ght_test_data(key, 0));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        CHECK(!ght_delete_hashed(table, stale[i], ght_test_key(0, i)));
+    }
+    
+    CHECK(!ght_load(table));
+    CHECK(!ght_destroy(table));
+    
+    // Byte-key tables have no integer hash.
+    table = ght_create(&(ght_cfg_t) {.key_mode = GHT_KEY_BYTES});
+    
+    CHECK(!ght_hash(table, 1));
+    CHECK(ght_insert_hashed(table, 1, 1, 1));
+    CHECK(!ght_destroy(table));
+    ght_thread_unregister();
+    
+    return 0;
+}
@@ -0,0 +1,51 @@
+// Compiles ght.hpp and runs the wrapper through inserts, lookups, erasure, moves and growth.
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "ght.hpp"
+
+#define CHECK(condition) do { if (!(condition)) { std::fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); return 1; } } while (0)
+
+int main()
+{
+    ght::table<std::string, std::unique_ptr<int>> table;
+    const int count = 20000;
+    
+    for (int i = 0; i < count; i++)
+    {
+        CHECK(table.try_emplace(std::to_string(i), std::make_unique<int>(i)).second);
+    }
+    
+    CHECK(table.size() == count);
+    CHECK(ght_load(table.native_handle()) == count);
+    CHECK(ght_width(table.native_handle()) >= count);
+    
+    std::string_view key = "123";
+    auto it = table.find(key);
+    
+    CHECK(it != table.end() && *it->second == 123);
+    CHECK(table.erase(std::string(key)) == 1);
+    CHECK(!table.contains(key));
+    
+    auto moved = std::move(table);
+    std::size_t visited = 0;
+    long long sum = 0;
+    
+    for (const auto& entry : moved)
+    {
+        CHECK(entry.first == std::to_string(*entry.second));
+        sum += *entry.second;
+        visited++;
+    }
+    
+    CHECK(visited == count - 1);
+    CHECK(sum == static_cast<long long>(count) * (count - 1) / 2 - 123);
+    
+    moved.clear();
+    CHECK(moved.empty() && ght_load(moved.native_handle()) == 0);
+    
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Incremental resize: ght_resize only allocates the new bucket array and each following operation migrates a few old
+// buckets. Inserts, lookups and deletes must see one table throughout, and a table destroyed mid-migration must hand
+// every entry to the deallocator once and free both arrays.
+
+#include "ght_test.h"
+
+#define GHT_TEST_WIDTH      (1024)
+
+static long _live;
+static size_t _deallocated;
+
+static void* _malloc(size_t size, void* context)
+{
+    (void) context;
+    _live++;
+    return malloc(size);
+}
+
+static void _free(void* ptr, void* context)
+{
+    (void) context;
+    _live -= ptr != NULL;
+    free(ptr);
+}
+
+static void _deallocator(ght_key_t key, ght_data_t data)
+{
+    CHECK(data >> 8 == key);
+    _deallocated++;
+}
+
+int main(void)
+{
+    ght_cfg_t cfg = {
+                        .width = GHT_TEST_WIDTH,
+                        .auto_resize = 0.0,
+                        .resize_mode = GHT_RESIZE_INCREMENTAL,
+                        .deallocator = _deallocator,
+                        .allocator = {.malloc = _malloc, .free = _free}
+                    };
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+    }
+    
+    long live = _live;
+    
+    CHECK(!ght_resize(table, GHT_TEST_WIDTH * 4));
+    CHECK(ght_width(table) == GHT_TEST_WIDTH * 4);
+    CHECK(_live == live + 1);
+    
+    // A few operations later most old buckets still hold their keys, which every operation must keep finding.
+    for (size_t i = 0; i < 16; i++)
+    {
+        ght_key_t key = ght_test_key(0, i * 997 % GHT_TEST_KEYS);
+        
+        CHECK(ght_search(table, key) == ght_test_data(key, 0));
+    }
+    
+    CHECK(_live == live + 1);
+    
+    // Deletes and replacements of keys wherever they are, and new keys placed by the same rule.
+    for (size_t i = 0; i < GHT_TEST_KEYS; i += 2)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(!ght_delete(table, key));
+        CHECK(!ght_search(table, key));
+        
+        key = ght_test_key(1, i);
+        
+        CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+        CHECK(!ght_insert(table, key, ght_test_data(key, 1)));
+    }
+    
+    // As many nodes were freed as allocated, and migrating 4 buckets per operation the 30000 operations above moved
+    // all 1024 and freed the old array.
+    CHECK(_live == live);
+    CHECK(ght_load(table) == GHT_TEST_KEYS);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        ght_key_t other = ght_test_key(1, i);
+        
+        CHECK(ght_search(table, key) == (i % 2 ? ght_test_data(key, 0) : 0));
+        CHECK(ght_search(table, other) == (i % 2 ? 0 : ght_test_data(other, 1)));
+    }
+    
+    // A resize requested mid-migration first finishes the current one, then the table goes away mid-migration.
+    CHECK(!ght_resize(table, GHT_TEST_WIDTH * 16));
+    CHECK(!ght_search(table, ght_test_key(2, 0)));
+    CHECK(!ght_resize(table, GHT_TEST_WIDTH * 64));
+    CHECK(ght_width(table) == GHT_TEST_WIDTH * 64);
+    
+    _deallocated = 0;
+    CHECK(!ght_destroy(table));
+    CHECK(_deallocated == GHT_TEST_KEYS);
+    CHECK(!_live);
+    
+    return 0;
+}
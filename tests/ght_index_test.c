@@ -0,0 +1,77 @@
+// Index policies: each one must map every hash, extreme ones included, to a bucket inside the table at the widths it
+// allows, so that keys are found again across resizes to odd and tiny widths.
+
+#include "ght_test.h"
+
+#define GHT_TEST_COUNT      (2000)      // Few enough keys to walk as one chain at width 1.
+
+static ght_hash_t _identity(ght_key_t key)
+{
+    return (ght_hash_t) key;
+}
+
+static ght_key_t _key(size_t i)
+{
+    // Small keys, keys with only high bits set and keys next to the largest hash.
+    switch (i % 3)
+    {
+        case 0: return (ght_key_t) i;
+        case 1: return (ght_key_t) i << 40;
+        default: return (ght_key_t) (UINT64_MAX - i);
+    }
+}
+
+static void _policy(ght_index_policy_t policy, bool pow2)
+{
+    static const ght_width_t widths[] = {1000, 1, 3, 12345, 64, 7};
+    ght_cfg_t cfg = {.width = widths[0], .auto_resize = 0.0, .index_policy = policy, .digestor = _identity};
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        CHECK(!ght_insert(table, _key(i), i + 1));
+    }
+    
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
+    {
+        ght_width_t width = ght_width(table);
+        
+        CHECK(pow2 ? width >= widths[w] && !(width & (width - 1)) : width == widths[w]);
+        
+        for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+        {
+            CHECK(ght_search(table, _key(i)) == i + 1);
+        }
+        
+        if (w + 1 < sizeof(widths) / sizeof(widths[0]))
+        {
+            CHECK(!ght_resize(table, widths[w + 1]));
+        }
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i += 2)
+    {
+        CHECK(!ght_delete(table, _key(i)));
+    }
+    
+    CHECK(ght_load(table) == GHT_TEST_COUNT / 2);
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        CHECK(ght_search(table, _key(i)) == (i % 2 ? i + 1 : 0));
+    }
+    
+    CHECK(!ght_destroy(table));
+}
+
+int main(void)
+{
+    _policy(GHT_INDEX_MODULO, false);
+    _policy(GHT_INDEX_POW2, true);
+    _policy(GHT_INDEX_FASTRANGE, false);
+    _policy(GHT_INDEX_RECIPROCAL, false);
+    
+    return 0;
+}
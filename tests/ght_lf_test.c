@@ -0,0 +1,110 @@
+// Split-ordered lock-free table: resizes only ever raise the bucket count, and keys stay visible to lock-free readers
+// while new buckets are split off their parents by the operations that first reach them.
+
+#include <stdatomic.h>
+
+#include "ght_test.h"
+
+#define GHT_TEST_MAX_WIDTH  (1 << 16)
+
+static atomic_bool _done;
+static size_t _added;                   // Keys inserted by the resizing thread, read after it joined.
+
+static int _worker(void* arg)
+{
+    ght_test_thread_t* thread = arg;
+    ght_lf_table_t* table = thread->table;
+    size_t i = thread->id;
+    
+    // Doubles the bucket count under the readers, inserting between doublings so splits happen on the way.
+    if (!thread->id)
+    {
+        for (ght_width_t width = 16; width <= GHT_TEST_MAX_WIDTH; width *= 2)
+        {
+            CHECK(!ght_lf_resize(table, width));
+            
+            for (size_t j = 0; j < GHT_TEST_KEYS / 16; j++)
+            {
+                ght_key_t key = ght_test_key(1, _added++);
+                
+                CHECK(!ght_lf_insert(table, key, ght_test_data(key, 0)));
+            }
+        }
+        
+        atomic_store_explicit(&_done, true, memory_order_release);
+        return 0;
+    }
+    
+    while (!atomic_load_explicit(&_done, memory_order_acquire))
+    {
+        ght_key_t key = ght_test_key(0, i % GHT_TEST_KEYS);
+        
+        CHECK(ght_lf_search(table, key) == ght_test_data(key, 0));
+        i += 7;
+    }
+    
+    return 0;
+}
+
+int main(void)
+{
+    ght_cfg_t cfg = {.width = 8, .auto_resize = 0.0};
+    ght_lf_table_t* table = ght_lf_create(&cfg);
+    
+    CHECK(table);
+    CHECK(ght_lf_width(table) == 8);
+    
+    // A smaller count would strand the sentinels of the buckets past it, widths are rounded up to a power of two.
+    CHECK(ght_lf_resize(table, 4));
+    CHECK(ght_lf_resize(table, 0));
+    CHECK(!ght_lf_resize(table, 8));
+    CHECK(ght_lf_width(table) == 8);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(!ght_lf_insert(table, key, ght_test_data(key, 0)));
+    }
+    
+    ght_test_run(_worker, table);
+    
+    CHECK(ght_lf_width(table) == GHT_TEST_MAX_WIDTH);
+    CHECK(ght_lf_resize(table, GHT_TEST_MAX_WIDTH / 2));
+    CHECK(!ght_lf_resize(table, GHT_TEST_MAX_WIDTH + 1));
+    CHECK(ght_lf_width(table) == GHT_TEST_MAX_WIDTH * 2);
+    
+    CHECK(ght_lf_load(table) == GHT_TEST_KEYS + _added);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(ght_lf_search(table, key) == ght_test_data(key, 0));
+        CHECK(!ght_lf_delete(table, key));
+        CHECK(ght_lf_delete(table, key));
+        CHECK(!ght_lf_search(table, key));
+    }
+    
+    CHECK(ght_lf_load(table) == _added);
+    CHECK(!ght_lf_destroy(table));
+    
+    // Without explicit resizes, auto_resize doubles the bucket count as the load grows.
+    cfg = (ght_cfg_t) {.width = 8, .auto_resize = 1.0};
+    table = ght_lf_create(&cfg);
+    
+    CHECK(table);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(!ght_lf_insert(table, key, ght_test_data(key, 0)));
+    }
+    
+    CHECK(ght_lf_load_factor(table) <= 1.0);
+    CHECK(!ght_lf_destroy(table));
+    ght_thread_unregister();
+    
+    return 0;
+}
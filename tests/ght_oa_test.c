@@ -0,0 +1,116 @@
+// Open-addressing engine: tombstones keep probe sequences intact, are reused by inserts and purged by same-width
+// rehashes, so churn at a steady load never grows the table.
+
+#include "ght_test.h"
+
+#define GHT_TEST_GROUP      (16)        // Control bytes matched at once.
+
+static size_t _deallocated;
+
+static ght_hash_t _constant(ght_key_t key)
+{
+    (void) key;
+    return 0x2545f491;
+}
+
+static void _deallocator(ght_key_t key, ght_data_t data)
+{
+    CHECK(data >> 8 == key);
+    _deallocated++;
+}
+
+int main(void)
+{
+    // Keys sharing one hash probe the same groups in the same order, the third group is only reached through two full ones.
+    ght_cfg_t cfg = {.engine = GHT_ENGINE_OPEN_ADDRESSING, .width = 64, .auto_resize = 0.0, .digestor = _constant};
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    CHECK(ght_width(table) == 64);
+    
+    for (size_t i = 0; i < GHT_TEST_GROUP * 5 / 2; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+    }
+    
+    // Deleting from the full groups leaves tombstones that lookups of the later keys must probe past.
+    for (size_t i = 0; i < GHT_TEST_GROUP * 2; i += 2)
+    {
+        CHECK(!ght_delete(table, ght_test_key(0, i)));
+        CHECK(ght_delete(table, ght_test_key(0, i)));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_GROUP * 5 / 2; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(ght_search(table, key) == (i < GHT_TEST_GROUP * 2 && i % 2 == 0 ? 0 : ght_test_data(key, 0)));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_GROUP * 2; i += 2)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(!ght_insert(table, key, ght_test_data(key, 1)));
+    }
+    
+    CHECK(ght_load(table) == GHT_TEST_GROUP * 5 / 2);
+    CHECK(ght_width(table) == 64);
+    
+    for (size_t i = 0; i < GHT_TEST_GROUP * 5 / 2; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(ght_search(table, key) == ght_test_data(key, i < GHT_TEST_GROUP * 2 && i % 2 == 0));
+    }
+    
+    CHECK(!ght_destroy(table));
+    
+    // A sliding window of live keys: every delete leaves a tombstone, which only rehashes at the same width clear.
+    cfg = (ght_cfg_t) {.engine = GHT_ENGINE_OPEN_ADDRESSING, .width = 256, .auto_resize = 0.75, .deallocator = _deallocator};
+    table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS * 5; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+        
+        if (i >= 100)
+        {
+            CHECK(!ght_delete(table, ght_test_key(0, i - 100)));
+        }
+    }
+    
+    CHECK(ght_load(table) == 100);
+    CHECK(ght_width(table) == 256);
+    CHECK(_deallocated == GHT_TEST_KEYS * 5 - 100);
+    
+    // Growth keeps widths a power of two and the load factor under the 0.875 the control groups allow.
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(1, i);
+        
+        CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+        CHECK(ght_load_factor(table) <= 0.875);
+    }
+    
+    CHECK(!(ght_width(table) & (ght_width(table) - 1)));
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(1, i);
+        
+        CHECK(ght_search(table, key) == ght_test_data(key, 0));
+    }
+    
+    _deallocated = 0;
+    CHECK(!ght_destroy(table));
+    CHECK(_deallocated == GHT_TEST_KEYS + 100);
+    
+    return 0;
+}
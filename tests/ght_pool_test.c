@@ -0,0 +1,129 @@
+// Node pool: deleted nodes go back to their slab or the thread's magazine and are reused by the next inserts, so a
+// table whose load stays put stops allocating. Threads recycling nodes through their magazines must never lose or
+// share one.
+
+#include <stdatomic.h>
+
+#include "ght_test.h"
+
+static atomic_size_t _allocations;
+static atomic_long _live;
+
+static void* _malloc(size_t size, void* context)
+{
+    (void) context;
+    atomic_fetch_add_explicit(&_allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_live, 1, memory_order_relaxed);
+    return malloc(size);
+}
+
+static void _free(void* ptr, void* context)
+{
+    (void) context;
+    
+    if (ptr)
+    {
+        atomic_fetch_sub_explicit(&_live, 1, memory_order_relaxed);
+    }
+    
+    free(ptr);
+}
+
+static int _worker(void* arg)
+{
+    ght_test_thread_t* thread = arg;
+    ght_table_t* table = thread->table;
+    
+    // Each round frees half the nodes into the thread's magazine and takes them back with the next one.
+    for (size_t round = 0; round < 4; round++)
+    {
+        for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+        {
+            ght_key_t key = ght_test_key(thread->id, i);
+            
+            CHECK(!ght_insert(table, key, ght_test_data(key, round)));
+        }
+        
+        for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+        {
+            ght_key_t key = ght_test_key(thread->id, i);
+            
+            CHECK(ght_search(table, key) == ght_test_data(key, round));
+            
+            if (i % 2)
+            {
+                CHECK(!ght_delete(table, key));
+            }
+        }
+    }
+    
+    return 0;
+}
+
+int main(void)
+{
+    ght_cfg_t cfg = {
+                        .width = GHT_TEST_KEYS,
+                        .auto_resize = 0.0,
+                        .node_pool = true,
+                        .allocator = {.malloc = _malloc, .free = _free}
+                    };
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+    }
+    
+    size_t allocations = atomic_load(&_allocations);
+    
+    // The same number of other keys fits in the nodes just freed.
+    for (size_t round = 1; round < 4; round++)
+    {
+        for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+        {
+            CHECK(!ght_delete(table, ght_test_key(round - 1, i)));
+        }
+        
+        for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+        {
+            ght_key_t key = ght_test_key(round, i);
+            
+            CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+        }
+        
+        CHECK(ght_load(table) == GHT_TEST_KEYS);
+        CHECK(atomic_load(&_allocations) == allocations);
+    }
+    
+    CHECK(!ght_destroy(table));
+    CHECK(!atomic_load(&_live));
+    
+    cfg.lock_stripes = 16;
+    table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    ght_test_run(_worker, table);
+    
+    CHECK(ght_load(table) == GHT_TEST_THREADS * GHT_TEST_KEYS / 2);
+    
+    for (size_t id = 0; id < GHT_TEST_THREADS; id++)
+    {
+        for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+        {
+            ght_key_t key = ght_test_key(id, i);
+            
+            CHECK(ght_search(table, key) == (i % 2 ? 0 : ght_test_data(key, 3)));
+        }
+    }
+    
+    CHECK(!ght_destroy(table));
+    CHECK(!atomic_load(&_live));
+    
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Read-mostly tables: lock-free lookups racing updates that replace nodes and resizes that copy the chains must find
+// every key that is never deleted, with one of the values it has held, on a table with a single lock.
+
+#include <stdatomic.h>
+
+#include "ght_test.h"
+
+#define GHT_TEST_VERSIONS   (8)
+
+static atomic_bool _done;
+
+static int _worker(void* arg)
+{
+    ght_test_thread_t* thread = arg;
+    ght_table_t* table = thread->table;
+    size_t i = thread->id;
+    
+    if (!thread->id)
+    {
+        for (size_t version = 1; version < GHT_TEST_VERSIONS; version++)
+        {
+            CHECK(!ght_resize(table, version % 2 ? GHT_TEST_KEYS * 2 : 64));
+            
+            for (size_t j = 0; j < GHT_TEST_KEYS; j++)
+            {
+                ght_key_t key = ght_test_key(0, j);
+                
+                CHECK(!ght_insert(table, key, ght_test_data(key, version)));
+            }
+        }
+        
+        atomic_store_explicit(&_done, true, memory_order_release);
+        return 0;
+    }
+    
+    while (!atomic_load_explicit(&_done, memory_order_acquire))
+    {
+        ght_key_t key = ght_test_key(0, i % GHT_TEST_KEYS);
+        ght_data_t data = ght_search(table, key);
+        
+        CHECK(data >> 8 == key && (data & 0xFF) >= 1 && (data & 0xFF) <= GHT_TEST_VERSIONS);
+        i += 7;
+    }
+    
+    return 0;
+}
+
+int main(void)
+{
+    ght_cfg_t cfg = {.width = 64, .auto_resize = 0.0, .read_mostly = true};
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+    }
+    
+    ght_test_run(_worker, table);
+    
+    CHECK(ght_load(table) == GHT_TEST_KEYS);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(ght_search(table, key) == ght_test_data(key, GHT_TEST_VERSIONS - 1));
+    }
+    
+    CHECK(!ght_destroy(table));
+    ght_thread_unregister();
+    
+    return 0;
+}
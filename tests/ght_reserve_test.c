@@ -0,0 +1,133 @@
+// Reserve and bulk build: ght_reserve sizes a table so that count entries go in without a resize, refuses counts no
+// width can hold without touching the table, and ght_create_from_arrays builds the same table as one insert per key
+// on every engine, leaving the data to the caller when it fails.
+
+#include <stdint.h>
+
+#include "ght_test.h"
+
+static long _live;
+static long _budget = -1;               // Allocations left before _malloc fails, negative for no limit.
+static size_t _deallocated;
+
+static void* _malloc(size_t size, void* context)
+{
+    (void) context;
+    
+    if (!_budget--) return NULL;
+    
+    _live++;
+    return malloc(size);
+}
+
+static void _free(void* ptr, void* context)
+{
+    (void) context;
+    _live -= ptr != NULL;
+    free(ptr);
+}
+
+static void _deallocator(ght_key_t key, ght_data_t data)
+{
+    (void) key;
+    (void) data;
+    _deallocated++;
+}
+
+static void _engine(ght_cfg_t cfg)
+{
+    static ght_key_t keys[GHT_TEST_KEYS];
+    static ght_data_t data[GHT_TEST_KEYS];
+    
+    cfg.auto_resize = 0.75;
+    
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    CHECK(!ght_insert(table, 1, 1));
+    
+    // Counts whose width overflows, or that no memory can back, fail and leave the table as it was.
+    ght_width_t width = ght_width(table);
+    
+    CHECK(ght_reserve(table, SIZE_MAX));
+    CHECK(ght_reserve(table, SIZE_MAX / 16 + 1));
+    CHECK(ght_reserve(table, SIZE_MAX / 17));
+    CHECK(ght_width(table) == width);
+    CHECK(ght_search(table, 1) == 1);
+    CHECK(!ght_reserve(table, 0));
+    CHECK(ght_width(table) == width);
+    
+    CHECK(!ght_reserve(table, GHT_TEST_KEYS));
+    width = ght_width(table);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        CHECK(!ght_insert(table, ght_test_key(0, i), i + 1));
+    }
+    
+    CHECK(ght_width(table) == width);
+    CHECK(!ght_destroy(table));
+    
+    // The second half repeats the keys of the first with other data, which must win.
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        keys[i] = ght_test_key(0, i % (GHT_TEST_KEYS / 2));
+        data[i] = i + 1;
+    }
+    
+    table = ght_create_from_arrays(&cfg, keys, data, GHT_TEST_KEYS);
+    
+    CHECK(table);
+    CHECK(ght_load(table) == GHT_TEST_KEYS / 2);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS / 2; i++)
+    {
+        CHECK(ght_search(table, ght_test_key(0, i)) == i + GHT_TEST_KEYS / 2 + 1);
+    }
+    
+    CHECK(!ght_destroy(table));
+    
+    // Fail each allocation of a build in turn, the caller keeps its data and nothing leaks.
+    cfg.deallocator = _deallocator;
+    cfg.allocator = (ght_allocator_t) {.malloc = _malloc, .free = _free};
+    _deallocated = 0;
+    
+    for (long budget = 0; ; budget += budget < 64 ? 1 : 997)
+    {
+        _budget = budget;
+        table = ght_create_from_arrays(&cfg, keys, data, GHT_TEST_KEYS / 2);
+        _budget = -1;
+        
+        if (table)
+        {
+            CHECK(!ght_destroy(table));
+            break;
+        }
+        
+        CHECK(!_live);
+    }
+    
+    CHECK(_deallocated == GHT_TEST_KEYS / 2);
+    CHECK(!_live);
+}
+
+int main(void)
+{
+    CHECK(!ght_create_from_arrays(NULL, NULL, NULL, 1));
+    CHECK(!ght_create_from_arrays(&(ght_cfg_t) {.key_mode = GHT_KEY_BYTES}, NULL, NULL, 0));
+    
+    ght_table_t* table = ght_create_from_arrays(NULL, NULL, NULL, 0);
+    
+    CHECK(table && !ght_load(table));
+    CHECK(!ght_destroy(table));
+    
+    _engine((ght_cfg_t) {0});
+    _engine((ght_cfg_t) {.node_pool = true, .lock_stripes = 8});
+    _engine((ght_cfg_t) {.resize_mode = GHT_RESIZE_INCREMENTAL});
+    _engine((ght_cfg_t) {.engine = GHT_ENGINE_OPEN_ADDRESSING});
+    _engine((ght_cfg_t) {.engine = GHT_ENGINE_ROBIN_HOOD});
+    _engine((ght_cfg_t) {.engine = GHT_ENGINE_CUCKOO});
+    ght_thread_unregister();
+    
+    return 0;
+}
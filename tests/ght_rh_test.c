@@ -0,0 +1,106 @@
+// Robin Hood engine: deletes shift the following displaced entries back instead of leaving tombstones, so runs of
+// colliding keys stay ordered and findable, a run reaches the longest distance its byte can hold, and churn at a
+// steady load never grows the table.
+
+#include "ght_test.h"
+
+#define GHT_TEST_DISTANCE   (255)       // Longest probe distance a slot can record.
+
+static ght_hash_t _constant(ght_key_t key)
+{
+    (void) key;
+    return 0x9e3779b9;
+}
+
+// Groups of 8 keys share a hash, so the runs of neighbouring homes merge into long clusters.
+static ght_hash_t _grouped(ght_key_t key)
+{
+    return (ght_hash_t) (key / 8) * 0x9e3779b97f4a7c15;
+}
+
+int main(void)
+{
+    ght_cfg_t cfg = {.engine = GHT_ENGINE_ROBIN_HOOD, .width = 1024, .auto_resize = 0.0, .digestor = _constant};
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    for (size_t i = 0; i < GHT_TEST_DISTANCE; i++)
+    {
+        CHECK(!ght_insert(table, ght_test_key(0, i), ght_test_data(ght_test_key(0, i), 0)));
+    }
+    
+    // One more key sharing the home slot would sit further away than the byte can say, at any width.
+    CHECK(ght_insert(table, ght_test_key(1, 0), 1));
+    CHECK(ght_load(table) == GHT_TEST_DISTANCE);
+    
+    // Deleting from the middle of the run pulls the rest one slot closer each time.
+    for (size_t i = 100; i < 200; i++)
+    {
+        CHECK(!ght_delete(table, ght_test_key(0, i)));
+        CHECK(ght_delete(table, ght_test_key(0, i)));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_DISTANCE; i++)
+    {
+        ght_key_t key = ght_test_key(0, i);
+        
+        CHECK(ght_search(table, key) == (i >= 100 && i < 200 ? 0 : ght_test_data(key, 0)));
+    }
+    
+    // The freed distances are usable again.
+    for (size_t i = 0; i < 100; i++)
+    {
+        CHECK(!ght_insert(table, ght_test_key(1, i), ght_test_data(ght_test_key(1, i), 0)));
+    }
+    
+    CHECK(ght_insert(table, ght_test_key(2, 0), 1));
+    CHECK(!ght_destroy(table));
+    
+    // A sliding window of clustered keys, which only stays at its width if deletes leave nothing behind.
+    cfg = (ght_cfg_t) {.engine = GHT_ENGINE_ROBIN_HOOD, .width = 512, .auto_resize = 0.0, .digestor = _grouped};
+    table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    ght_width_t width = ght_width(table);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS * 5; i++)
+    {
+        CHECK(!ght_insert(table, (ght_key_t) i, ght_test_data(i, 0)));
+        
+        if (i >= 256)
+        {
+            CHECK(!ght_delete(table, (ght_key_t) (i - 256)));
+        }
+        
+        if (i % 1000 == 0)
+        {
+            for (size_t j = i > 256 ? i - 255 : 0; j <= i; j++)
+            {
+                CHECK(ght_search(table, (ght_key_t) j) == ght_test_data(j, 0));
+            }
+        }
+    }
+    
+    CHECK(ght_load(table) == 256);
+    CHECK(ght_width(table) == width);
+    
+    // Growth keeps at least a tenth of the slots empty.
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(1, i) << 20;
+        
+        CHECK(!ght_insert(table, key, i + 1));
+        CHECK(ght_load(table) <= ght_width(table) - ght_width(table) / 10);
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        CHECK(ght_search(table, ght_test_key(1, i) << 20) == i + 1);
+    }
+    
+    CHECK(!ght_destroy(table));
+    
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Seeding: re-seeding is only accepted where every hash depends on the seed, each re-seed waits for the load to
+// double, and threads inserting while the table re-seeds under them lose no key.
+
+#include <threads.h>
+
+#include "ght_test.h"
+
+#define GHT_TEST_COUNT      (GHT_TEST_KEYS / 4)
+#define GHT_TEST_SEEDS      (64)
+
+static mtx_t _mutex;
+static uint64_t _seeds[GHT_TEST_SEEDS];
+static size_t _seed_count;
+
+// 64 hashes per seed whatever the key, so chains outgrow any width and keep asking for a re-seed.
+static ght_hash_t _weak(ght_key_t key, uint64_t seed)
+{
+    mtx_lock(&_mutex);
+    
+    size_t i = 0;
+    
+    while (i < _seed_count && _seeds[i] != seed) i++;
+    
+    if (i == _seed_count)
+    {
+        CHECK(_seed_count < GHT_TEST_SEEDS);
+        _seeds[_seed_count++] = seed;
+    }
+    
+    mtx_unlock(&_mutex);
+    return ght_digestor_mum(key % 64, seed);
+}
+
+static ght_hash_t _plain(ght_key_t key)
+{
+    return (ght_hash_t) key;
+}
+
+static int _worker(void* arg)
+{
+    ght_test_thread_t* thread = arg;
+    ght_table_t* table = thread->table;
+    
+    for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+    {
+        ght_key_t key = ght_test_key(thread->id, i);
+        
+        CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+        CHECK(ght_search(table, key) == ght_test_data(key, 0));
+    }
+    
+    return 0;
+}
+
+static bool _accepts(ght_cfg_t cfg)
+{
+    cfg.reseed_chain = 4;
+    
+    ght_table_t* table = ght_create(&cfg);
+    
+    if (!table) return false;
+    
+    CHECK(!ght_destroy(table));
+    return true;
+}
+
+int main(void)
+{
+    CHECK(mtx_init(&_mutex, mtx_plain) == thrd_success);
+    
+    // A digestor that ignores the seed, or readers that would hash with a seed the buckets don't use yet, can't re-seed.
+    CHECK(_accepts((ght_cfg_t) {0}));
+    CHECK(_accepts((ght_cfg_t) {.keyed_digestor = _weak, .lock_stripes = 8}));
+    CHECK(_accepts((ght_cfg_t) {.key_mode = GHT_KEY_BYTES}));
+    CHECK(!_accepts((ght_cfg_t) {.digestor = _plain}));
+    CHECK(!_accepts((ght_cfg_t) {.read_mostly = true}));
+    CHECK(!_accepts((ght_cfg_t) {.engine = GHT_ENGINE_OPEN_ADDRESSING}));
+    CHECK(!_accepts((ght_cfg_t) {.engine = GHT_ENGINE_CUCKOO}));
+    
+    ght_cfg_t cfg = {.keyed_digestor = _weak, .seed = 1, .reseed_chain = 4, .auto_resize = 1.0, .lock_stripes = 8};
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    ght_test_run(_worker, table);
+    
+    // The configured seed, then at most one re-seed per doubling of the load.
+    size_t doublings = 0;
+    
+    for (size_t load = 1; load < GHT_TEST_THREADS * GHT_TEST_COUNT; load *= 2) doublings++;
+    
+    CHECK(_seed_count >= 2 && _seed_count <= doublings + 1);
+    CHECK(ght_load(table) == GHT_TEST_THREADS * GHT_TEST_COUNT);
+    
+    for (size_t id = 0; id < GHT_TEST_THREADS; id++)
+    {
+        for (size_t i = 0; i < GHT_TEST_COUNT; i++)
+        {
+            ght_key_t key = ght_test_key(id, i);
+            
+            CHECK(ght_search(table, key) == ght_test_data(key, 0));
+        }
+    }
+    
+    CHECK(!ght_destroy(table));
+    mtx_destroy(&_mutex);
+    
+    return 0;
+}
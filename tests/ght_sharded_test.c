@@ -0,0 +1,112 @@
+// Sharded tables: the width is split between a power-of-two number of shards, a creation that fails part way frees
+// every shard made so far, and threads working on all shards at once see one table.
+
+#include <stdatomic.h>
+
+#include "ght_test.h"
+
+static atomic_long _live;
+static atomic_long _budget;             // Allocations left before _malloc fails, negative for no limit.
+
+static void* _malloc(size_t size, void* context)
+{
+    (void) context;
+    
+    if (!atomic_fetch_sub(&_budget, 1)) return NULL;
+    
+    atomic_fetch_add_explicit(&_live, 1, memory_order_relaxed);
+    return malloc(size);
+}
+
+static void _free(void* ptr, void* context)
+{
+    (void) context;
+    
+    if (ptr)
+    {
+        atomic_fetch_sub_explicit(&_live, 1, memory_order_relaxed);
+    }
+    
+    free(ptr);
+}
+
+static int _worker(void* arg)
+{
+    ght_test_thread_t* thread = arg;
+    ght_sharded_t* table = thread->table;
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(thread->id, i);
+        
+        CHECK(!ght_sharded_insert(table, key, ght_test_data(key, 0)));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i += 2)
+    {
+        ght_key_t key = ght_test_key(thread->id, i);
+        
+        CHECK(!ght_sharded_delete(table, key));
+        CHECK(ght_sharded_delete(table, key));
+    }
+    
+    return 0;
+}
+
+int main(void)
+{
+    ght_cfg_t cfg = {.width = 1000, .auto_resize = 1.0, .allocator = {.malloc = _malloc, .free = _free}};
+    
+    atomic_store(&_budget, -1);
+    
+    CHECK(!ght_sharded_create(&cfg, 0));
+    CHECK(!ght_sharded_create(&(ght_cfg_t) {.key_mode = GHT_KEY_BYTES}, 4));
+    
+    // Fail each allocation of a creation in turn, none of them may leak what came before.
+    for (long budget = 0; ; budget++)
+    {
+        atomic_store(&_budget, budget);
+        
+        ght_sharded_t* table = ght_sharded_create(&cfg, 5);
+        
+        atomic_store(&_budget, -1);
+        
+        if (table)
+        {
+            CHECK(!ght_sharded_destroy(table));
+            CHECK(!atomic_load(&_live));
+            break;
+        }
+        
+        CHECK(!atomic_load(&_live));
+    }
+    
+    ght_sharded_t* table = ght_sharded_create(&cfg, 5);
+    
+    CHECK(table);
+    CHECK(ght_sharded_width(table) == 1000);
+    
+    ght_test_run(_worker, table);
+    
+    CHECK(ght_sharded_load(table) == GHT_TEST_THREADS * GHT_TEST_KEYS / 2);
+    CHECK(ght_sharded_load_factor(table) <= 1.0);
+    
+    CHECK(!ght_sharded_resize(table, 1 << 20));
+    CHECK(ght_sharded_width(table) == 1 << 20);
+    
+    for (size_t id = 0; id < GHT_TEST_THREADS; id++)
+    {
+        for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+        {
+            ght_key_t key = ght_test_key(id, i);
+            
+            CHECK(ght_sharded_search(table, key) == (i % 2 ? ght_test_data(key, 0) : 0));
+        }
+    }
+    
+    CHECK(!ght_sharded_destroy(table));
+    CHECK(!atomic_load(&_live));
+    CHECK(ght_sharded_destroy(NULL));
+    
+    return 0;
+}
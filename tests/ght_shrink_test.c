@@ -0,0 +1,71 @@
+// Shrink thresholds: ght_create accepts auto_shrink only below half of auto_resize, and each engine that shrinks
+// halves its width on delete without going below the width it was created with.
+
+#include "ght_test.h"
+
+static bool _accepts(ght_load_factor_t auto_resize, ght_load_factor_t auto_shrink)
+{
+    ght_cfg_t cfg = {.width = 64, .auto_resize = auto_resize, .auto_shrink = auto_shrink};
+    ght_table_t* table = ght_create(&cfg);
+    
+    if (!table) return false;
+    
+    CHECK(!ght_destroy(table));
+    return true;
+}
+
+static void _shrink(ght_engine_t engine)
+{
+    ght_cfg_t cfg = {.width = 64, .auto_resize = 0.75, .auto_shrink = 0.25, .engine = engine};
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    ght_width_t initial = ght_width(table);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        CHECK(!ght_insert(table, ght_test_key(0, i), ght_test_data(ght_test_key(0, i), 0)));
+    }
+    
+    ght_width_t grown = ght_width(table);
+    
+    CHECK(grown > initial);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        CHECK(!ght_delete(table, ght_test_key(0, i)));
+        CHECK(ght_width(table) >= initial);
+        
+        // Whatever the width, the keys not deleted yet are still there.
+        if (i % 1000 == 0)
+        {
+            for (size_t j = i + 1; j < GHT_TEST_KEYS; j += 97)
+            {
+                CHECK(ght_search(table, ght_test_key(0, j)) == ght_test_data(ght_test_key(0, j), 0));
+            }
+        }
+    }
+    
+    CHECK(ght_load(table) == 0);
+    CHECK(ght_width(table) < grown);
+    CHECK(!ght_destroy(table));
+}
+
+int main(void)
+{
+    CHECK(_accepts(0.75, 0.25));
+    CHECK(_accepts(1.0, 0.49));
+    CHECK(_accepts(2.0, 0.5));
+    CHECK(_accepts(0.75, 0.0));
+    CHECK(_accepts(0.0, 0.25));
+    CHECK(!_accepts(0.5, 0.25));
+    CHECK(!_accepts(0.75, 0.5));
+    CHECK(!_accepts(1.0, 0.75));
+    
+    _shrink(GHT_ENGINE_CHAINED);
+    _shrink(GHT_ENGINE_OPEN_ADDRESSING);
+    _shrink(GHT_ENGINE_ROBIN_HOOD);
+    
+    return 0;
+}
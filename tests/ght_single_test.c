@@ -0,0 +1,95 @@
+// Single-header mode, built once with GHT_STATIC against src and once with GHT_IMPLEMENTATION against the generated
+// single/ght.h, neither linked to libght: the tables, the reclaimer and cooperative resizes all work from ght.h alone.
+
+#include "ght.h"        // Ahead of the system headers in ght_test.h, so that ght.c sees _DEFAULT_SOURCE
+
+#include "ght_test.h"
+
+#if !defined(GHT_IMPLEMENTATION_INCLUDED)
+#error "ght.h did not include the implementation"
+#endif
+
+static int _worker(void* arg)
+{
+    ght_test_thread_t* thread = arg;
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(thread->id, i);
+        
+        CHECK(!ght_insert(thread->table, key, ght_test_data(key, 0)));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i += 2)
+    {
+        CHECK(!ght_delete(thread->table, ght_test_key(thread->id, i)));
+    }
+    
+    return 0;
+}
+
+static int _lf_worker(void* arg)
+{
+    ght_test_thread_t* thread = arg;
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(thread->id, i);
+        
+        CHECK(!ght_lf_insert(thread->table, key, ght_test_data(key, 0)));
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i += 2)
+    {
+        CHECK(!ght_lf_delete(thread->table, ght_test_key(thread->id, i)));
+    }
+    
+    ght_thread_unregister();
+    return 0;
+}
+
+int main(void)
+{
+    ght_cfg_t cfg = {.width = 16, .auto_resize = 1.0, .resize_mode = GHT_RESIZE_COOPERATIVE};
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    
+    ght_test_run(_worker, table);
+    
+    CHECK(ght_load(table) == GHT_TEST_THREADS * GHT_TEST_KEYS / 2);
+    CHECK(ght_width(table) > 16);
+    
+    for (size_t id = 0; id < GHT_TEST_THREADS; id++)
+    {
+        for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+        {
+            ght_key_t key = ght_test_key(id, i);
+            
+            CHECK(ght_search(table, key) == (i % 2 ? ght_test_data(key, 0) : 0));
+        }
+    }
+    
+    CHECK(!ght_destroy(table));
+    
+    ght_lf_table_t* lf = ght_lf_create(&(ght_cfg_t) {.width = 16, .auto_resize = 1.0});
+    
+    CHECK(lf);
+    
+    ght_test_run(_lf_worker, lf);
+    
+    for (size_t id = 0; id < GHT_TEST_THREADS; id++)
+    {
+        for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+        {
+            ght_key_t key = ght_test_key(id, i);
+            
+            CHECK(ght_lf_search(lf, key) == (i % 2 ? ght_test_data(key, 0) : 0));
+        }
+    }
+    
+    CHECK(!ght_lf_destroy(lf));
+    ght_thread_unregister();
+    
+    return 0;
+}
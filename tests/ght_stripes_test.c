@@ -0,0 +1,70 @@
+// Striped locks: the stripe count is rounded up to a power of two and widths stay a multiple of it, and threads
+// inserting, updating and deleting through different stripes while the table grows keep every per-stripe counter right.
+
+#include "ght_test.h"
+
+#define GHT_TEST_STRIPES    (8)
+
+static int _worker(void* arg)
+{
+    ght_test_thread_t* thread = arg;
+    ght_table_t* table = thread->table;
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(thread->id, i);
+        
+        CHECK(!ght_insert(table, key, ght_test_data(key, 0)));
+        CHECK(ght_load(table) <= GHT_TEST_THREADS * GHT_TEST_KEYS);
+        CHECK(ght_width(table) % GHT_TEST_STRIPES == 0);
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        ght_key_t key = ght_test_key(thread->id, i);
+        
+        if (i % 3)
+        {
+            CHECK(!ght_insert(table, key, ght_test_data(key, 1)));
+        }
+        else
+        {
+            CHECK(!ght_delete(table, key));
+        }
+    }
+    
+    return 0;
+}
+
+int main(void)
+{
+    ght_cfg_t cfg = {.width = 100, .auto_resize = 1.0, .lock_stripes = GHT_TEST_STRIPES - 2};
+    ght_table_t* table = ght_create(&cfg);
+    
+    CHECK(table);
+    CHECK(ght_width(table) >= 100 && ght_width(table) % GHT_TEST_STRIPES == 0);
+    
+    CHECK(!ght_resize(table, 1001));
+    CHECK(ght_width(table) >= 1001 && ght_width(table) % GHT_TEST_STRIPES == 0);
+    
+    ght_test_run(_worker, table);
+    
+    size_t deleted = (GHT_TEST_KEYS + 2) / 3;
+    
+    CHECK(ght_load(table) == GHT_TEST_THREADS * (GHT_TEST_KEYS - deleted));
+    CHECK(ght_width(table) % GHT_TEST_STRIPES == 0);
+    
+    for (size_t id = 0; id < GHT_TEST_THREADS; id++)
+    {
+        for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+        {
+            ght_key_t key = ght_test_key(id, i);
+            
+            CHECK(ght_search(table, key) == (i % 3 ? ght_test_data(key, 1) : 0));
+        }
+    }
+    
+    CHECK(!ght_destroy(table));
+    
+    return 0;
+}
@@ -0,0 +1,52 @@
+// Helpers shared by the stress tests: a check that fails the whole test from any thread, and a thread runner.
+
+#ifndef GHT_TEST_H
+#define GHT_TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "ght.h"
+
+#define GHT_TEST_THREADS    (4)
+#define GHT_TEST_KEYS       (20000)     // Keys owned by each thread.
+
+#define CHECK(condition) do { if (!(condition)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); exit(1); } } while (0)
+
+typedef struct ght_test_thread
+{
+    void* table;
+    size_t id;
+} ght_test_thread_t;
+
+// Key i of thread id, never 0 and never shared with another thread.
+static inline ght_key_t ght_test_key(size_t id, size_t i)
+{
+    return (ght_key_t) (i * GHT_TEST_THREADS + id + 1);
+}
+
+// Data stored for a key at a given version, never 0 so that a search can tell it from a miss.
+static inline ght_data_t ght_test_data(ght_key_t key, size_t version)
+{
+    return (ght_data_t) (key << 8 | (version + 1));
+}
+
+static inline void ght_test_run(thrd_start_t worker, void* table)
+{
+    thrd_t threads[GHT_TEST_THREADS];
+    ght_test_thread_t args[GHT_TEST_THREADS];
+    
+    for (size_t i = 0; i < GHT_TEST_THREADS; i++)
+    {
+        args[i] = (ght_test_thread_t) {.table = table, .id = i};
+        CHECK(thrd_create(&threads[i], worker, &args[i]) == thrd_success);
+    }
+    
+    for (size_t i = 0; i < GHT_TEST_THREADS; i++)
+    {
+        CHECK(thrd_join(threads[i], NULL) == thrd_success);
+    }
+}
+
+#endif
@@ -0,0 +1,122 @@
+// Type-specialized tables: inserts replace, deletes leave tombstones that later inserts reuse, churn at a steady
+// load rebuilds in place instead of growing, and every entry survives growth and explicit resizes.
+
+#include "ght_test.h"
+
+#define GHT_TEST_CHURN          (GHT_TEST_KEYS * 10)    // Delete and reinsert rounds at a steady load
+#define GHT_TEST_STEADY         1000                    // Entries kept while churning
+
+#define _IDENTITY(key)          ((ght_hash_t) (key))
+
+GHT_DEFINE_TABLE(u64map, uint64_t, double, ght_hash_int, GHT_EQUAL)
+GHT_DEFINE_TABLE(idmap, uint32_t, uint64_t, _IDENTITY, GHT_EQUAL)
+
+static void _contents(u64map_t* table, size_t from, size_t to)
+{
+    for (size_t i = from; i < to; i++)
+    {
+        double* value = u64map_search(table, ght_test_key(0, i));
+        
+        CHECK(value && *value == (double) i);
+    }
+}
+
+int main(void)
+{
+    u64map_t* table = u64map_create(5);
+    
+    CHECK(table);
+    CHECK(u64map_width(table) == 8);
+    CHECK(u64map_load(table) == 0);
+    CHECK(!u64map_search(table, 1));
+    CHECK(u64map_delete(table, 1));
+    
+    // Growth keeps every entry, and a replaced value does not add to the load.
+    for (size_t i = 0; i < GHT_TEST_KEYS; i++)
+    {
+        CHECK(!u64map_insert(table, ght_test_key(0, i), -1.0));
+        CHECK(!u64map_insert(table, ght_test_key(0, i), (double) i));
+        CHECK(u64map_load(table) == i + 1);
+        CHECK(u64map_load(table) <= u64map_width(table) / 4 * 3);
+    }
+    
+    _contents(table, 0, GHT_TEST_KEYS);
+    
+    // The returned pointer writes through to the table.
+    *u64map_search(table, ght_test_key(0, 0)) = 0.5;
+    CHECK(*u64map_search(table, ght_test_key(0, 0)) == 0.5);
+    *u64map_search(table, ght_test_key(0, 0)) = 0.0;
+    
+    // Deleting every other key leaves the rest reachable past the tombstones, and a second delete fails.
+    for (size_t i = 0; i < GHT_TEST_KEYS; i += 2)
+    {
+        CHECK(!u64map_delete(table, ght_test_key(0, i)));
+        CHECK(u64map_delete(table, ght_test_key(0, i)));
+        CHECK(!u64map_search(table, ght_test_key(0, i)));
+    }
+    
+    CHECK(u64map_load(table) == GHT_TEST_KEYS / 2);
+    
+    for (size_t i = 1; i < GHT_TEST_KEYS; i += 2)
+    {
+        double* value = u64map_search(table, ght_test_key(0, i));
+        
+        CHECK(value && *value == (double) i);
+    }
+    
+    // Reinserting the deleted keys fills tombstones without growing.
+    ght_width_t width = u64map_width(table);
+    
+    for (size_t i = 0; i < GHT_TEST_KEYS; i += 2)
+    {
+        CHECK(!u64map_insert(table, ght_test_key(0, i), (double) i));
+    }
+    
+    CHECK(u64map_width(table) == width);
+    CHECK(u64map_load(table) == GHT_TEST_KEYS);
+    _contents(table, 0, GHT_TEST_KEYS);
+    
+    // A resize below 4/3 of the load fails and leaves the table as it was, a larger one keeps every entry.
+    CHECK(u64map_resize(table, GHT_TEST_KEYS / 2));
+    CHECK(u64map_width(table) == width);
+    CHECK(!u64map_resize(table, width * 4));
+    CHECK(u64map_width(table) == width * 4);
+    _contents(table, 0, GHT_TEST_KEYS);
+    CHECK(!u64map_resize(table, GHT_TEST_KEYS));
+    CHECK(u64map_width(table) == width);
+    _contents(table, 0, GHT_TEST_KEYS);
+    CHECK(!u64map_destroy(table));
+    
+    // Churn at a steady load: tombstones pile up until an insert rebuilds at the same width.
+    idmap_t* churn = idmap_create(GHT_TEST_STEADY * 2);
+    
+    CHECK(churn);
+    
+    width = idmap_width(churn);
+    
+    for (uint32_t i = 0; i < GHT_TEST_STEADY; i++) CHECK(!idmap_insert(churn, i, i));
+    
+    for (uint32_t i = GHT_TEST_STEADY; i < GHT_TEST_CHURN; i++)
+    {
+        CHECK(!idmap_delete(churn, i - GHT_TEST_STEADY));
+        CHECK(!idmap_insert(churn, i, i));
+        CHECK(idmap_load(churn) == GHT_TEST_STEADY);
+        CHECK(idmap_width(churn) == width);
+    }
+    
+    for (uint32_t i = GHT_TEST_CHURN - GHT_TEST_STEADY; i < GHT_TEST_CHURN; i++)
+    {
+        uint64_t* value = idmap_search(churn, i);
+        
+        CHECK(value && *value == i);
+    }
+    
+    CHECK(!idmap_search(churn, GHT_TEST_CHURN - GHT_TEST_STEADY - 1));
+    CHECK(!idmap_destroy(churn));
+    
+    CHECK(u64map_destroy(NULL));
+    CHECK(u64map_insert(NULL, 1, 1.0));
+    CHECK(!u64map_search(NULL, 1));
+    
+    return 0;
+}